@@ -46,12 +46,45 @@
  *
  *****************************************************************************/
 
+#ifndef COMMON_EXT_H_
+#define COMMON_EXT_H_
+
+#include "common.h"
+
 /*
  *===========================================================================
  *                             MACROS
  *===========================================================================
  */
 
+/* Task states */
+#define BLK_SEND            6       /* blocked on sending to a full mailbox */
+#define BLK_POOL            7       /* pool worker waiting for a job */
+
+/* Message priority, only honoured by mailboxes created with mbx_create_prio.
+   OR MSG_PRIO(p) into RTX_MSG_HDR.type, higher p is dequeued first,
+   untagged messages have priority 0 */
+#define MBX_MAX_CLASSES     4
+#define MSG_PRIO_SHIFT      24
+#define MSG_PRIO(p)         ((U32) (p) << MSG_PRIO_SHIFT)
+#define MSG_PRIO_OF(type)   (((U32) (type) >> MSG_PRIO_SHIFT) & 0xFF)
+#define MSG_TYPE_OF(type)   ((U32) (type) & ((1U << MSG_PRIO_SHIFT) - 1))
+
+/* recv_msg_batch stores each message on a 4B boundary, this steps to the next one */
+#define MSG_BATCH_NEXT(p_hdr) \
+    ((RTX_MSG_HDR *) ((U8 *) (p_hdr) + (((p_hdr)->length + 3U) & ~3U)))
+
+/* Worker pool, see pool_create */
+#define POOL_MAX_WORKERS    16      /* most workers pool_create makes       */
+#define POOL_QUEUE_SIZE     32      /* jobs waiting for a worker, a power of 2 */
+
+/* KCD */
+#define KCD_CMD_PREFIX      '%'     /* every console command starts with it */
+#define KCD_CMD_BUF_SIZE    64      /* longest command line the KCD accepts */
+#define KCD_LINE_SIZE       80      /* longest DISPLAY line the KCD emits   */
+#define KCD_STACK_SIZE      0x800   /* user stack of the KCD, the listings
+                                       format lines on it                   */
+
 /*
  *===========================================================================
  *                             TYPEDEFS
@@ -64,7 +97,70 @@
  *                             STRUCTURES
  *===========================================================================
  */
- 
+
+/**
+ * @brief Task statistics, one record per non-dormant task
+ */
+typedef struct rtx_task_stat {
+    task_t              tid;                /**> task ID                            */
+    U8                  prio;               /**> execution priority                 */
+    U8                  state;              /**> task state                         */
+    U8                  priv;               /**> = 0 unprivileged, =1 privileged    */
+    U32                 run_time;           /**> accumulated run time in usec       */
+    U16                 k_stack_used;       /**> kernel stack high-water in bytes   */
+    U16                 u_stack_used;       /**> user stack high-water in bytes     */
+} RTX_TASK_STAT;
+
+/**
+ * @brief Hardware event totals of one task, counted while it ran
+ */
+typedef struct rtx_pmu_stat {
+    U64                 cycles;             /**> cpu cycles                         */
+    U64                 insts;              /**> instructions executed              */
+    U64                 dcache_miss;        /**> L1 data cache refills              */
+    U64                 br_mispred;         /**> mispredicted branches              */
+} RTX_PMU_STAT;
+
+/**
+ * @brief One profiler sample, see prof_start
+ */
+typedef struct rtx_prof_sample {
+    U32                 pc;                 /**> interrupted program counter        */
+    task_t              tid;                /**> task running at the time           */
+    U8                  mode;               /**> processor mode, CPSR[4:0]          */
+    U16                 rsvd;
+} RTX_PROF_SAMPLE;
+
+/**
+ * @brief One job of the worker pool, a worker calls fn(arg)
+ */
+typedef struct rtx_pool_job {
+    void              (*fn)(void *arg);     /**> job entry                          */
+    void               *arg;                /**> passed to fn                       */
+} RTX_POOL_JOB;
+
+/**
+ * @brief Mailbox statistics, one record per mailbox
+ */
+typedef struct rtx_mbx_info {
+    task_t              tid;                /**> owner task ID                      */
+    U32                 size;               /**> capacity in bytes                  */
+    U32                 used;               /**> bytes in use                       */
+    U32                 count;              /**> number of queued messages          */
+    U32                 drops;              /**> sends rejected since creation      */
+} RTX_MBX_INFO;
+
+/**
+ * @brief Consistent view of all tasks and mailboxes at one instant
+ */
+typedef struct rtx_snapshot {
+    U32                 timestamp;          /**> A9 timer value, usec, counts down  */
+    int                 num_tasks;          /**> valid entries in tasks[]           */
+    int                 num_mbx;            /**> valid entries in mbx[]             */
+    RTX_TASK_STAT       tasks[MAX_TASKS];
+    RTX_MBX_INFO        mbx[MAX_TASKS];
+} RTX_SNAPSHOT;
+
 
 
  /*
@@ -73,6 +169,7 @@
   *===========================================================================
   */
 
+#endif // ! COMMON_EXT_H_
 
  /*
   *===========================================================================
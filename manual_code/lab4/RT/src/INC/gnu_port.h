@@ -0,0 +1,113 @@
+/*
+ ****************************************************************************
+ *
+ *                  UNIVERSITY OF WATERLOO ECE 350 RTOS LAB
+ *
+ *                     Copyright 2020-2021 Yiqing Huang
+ *
+ *          This software is subject to an open source license and
+ *          may be freely redistributed under the terms of MIT License.
+ ****************************************************************************
+ */
+
+/**************************************************************************//**
+ * @file        gnu_port.h
+ * @brief       armcc language extensions for the GNU arm-none-eabi build
+ *
+ * @version     V1.2021.01
+ * @authors     Yiqing Huang
+ * @date        2021 JAN
+ *
+ * @note        The Makefile force-includes this file (-include) into every C
+ *              file, so the sources keep using the armcc intrinsics.
+ *              The embedded assembly of HAL_CA.c and startup_a9.s has GAS
+ *              twins in HAL_CA_gnu.S and startup_a9_gnu.S.
+ *
+ *****************************************************************************/
+
+#ifndef GNU_PORT_H_
+#define GNU_PORT_H_
+
+#ifndef __ASSEMBLER__
+
+/* the board headers typedef uint32_t as unsigned int, as armcc's
+   <stdint.h> does; the freestanding GCC one would use unsigned long */
+#undef  __UINT32_TYPE__
+#define __UINT32_TYPE__ unsigned int
+#undef  __INT32_TYPE__
+#define __INT32_TYPE__  int
+
+/* the rtx.h system calls are SVC stubs in HAL_CA_gnu.S */
+#define __svc(n)
+#define __int64         long long
+
+/* returns non-zero if IRQs were already masked, as the armcc one does */
+static inline int __disable_irq(void)
+{
+    unsigned int cpsr;
+
+    __asm volatile ("mrs %0, cpsr\n\tcpsid i" : "=r" (cpsr) : : "memory");
+    return (int) (cpsr & 0x80U);
+}
+
+static inline void __enable_irq(void)
+{
+    __asm volatile ("cpsie i" : : : "memory");
+}
+
+static inline void __wfi(void)
+{
+    __asm volatile ("wfi" : : : "memory");
+}
+
+/* armcc takes the barrier option, the kernel only uses 0xF (SY) */
+#define __dsb(opt)      __asm volatile ("dsb" : : : "memory")
+#define __isb(opt)      __asm volatile ("isb" : : : "memory")
+
+static inline unsigned int __current_sp(void)
+{
+    unsigned int sp;
+
+    __asm volatile ("mov %0, sp" : "=r" (sp));
+    return sp;
+}
+
+/* CLZ of 0 is 32, unlike __builtin_clz */
+static inline unsigned int __clz(unsigned int x)
+{
+    unsigned int n;
+
+    __asm ("clz %0, %1" : "=r" (n) : "r" (x));
+    return n;
+}
+
+static inline unsigned int __ldrex(volatile void *p)
+{
+    unsigned int v;
+
+    __asm volatile ("ldrex %0, [%1]" : "=r" (v) : "r" (p) : "memory");
+    return v;
+}
+
+/* 0 if the store went through */
+static inline int __strex(unsigned int v, volatile void *p)
+{
+    int fail;
+
+    __asm volatile ("strex %0, %2, [%1]" : "=&r" (fail) : "r" (p), "r" (v) : "memory");
+    return fail;
+}
+
+static inline void __clrex(void)
+{
+    __asm volatile ("clrex" : : : "memory");
+}
+
+#endif /* !__ASSEMBLER__ */
+
+#endif /* GNU_PORT_H_ */
+/*
+ *===========================================================================
+ *                             END OF FILE
+ *===========================================================================
+ */
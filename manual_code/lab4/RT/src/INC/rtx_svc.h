@@ -0,0 +1,97 @@
+/*
+ ****************************************************************************
+ *
+ *                  UNIVERSITY OF WATERLOO ECE 350 RTOS LAB
+ *
+ *                     Copyright 2020-2021 Yiqing Huang
+ *
+ *          This software is subject to an open source license and
+ *          may be freely redistributed under the terms of MIT License.
+ ****************************************************************************
+ */
+
+/**************************************************************************//**
+ * @file        rtx_svc.h
+ * @brief       The system call table, one line per call
+ *
+ * @version     V1.2021.01
+ * @authors     Yiqing Huang
+ * @date        2021 JAN
+ *
+ * @details     RTX_SVC_LEAF(name, ret, params, args)
+ *                  a call that never blocks or switches, SVC_Handler runs
+ *                  it without the exception frame
+ *              RTX_SVC(name, ret, params, args)
+ *                  any other call
+ *              name is the user API function, k_<name> the kernel one.
+ *              The includer defines both macros. rtx.h makes the SVC
+ *              numbers and the wrappers out of this list, k_svc.c the
+ *              dispatch table, HAL_CA_gnu.S and HAL_HOST.c their stubs.
+ *              The leaf calls get the numbers 0 .. SVC_NUM_LEAF - 1,
+ *              the others follow, each group in the order listed here.
+ *
+ * @note        No include guard, the list is expanded several times.
+ *              Kept free of C so the assembler can include it too
+ *
+ *****************************************************************************/
+
+/* memory management */
+RTX_SVC     (mem_init,          int,    (void),                             ())
+RTX_SVC_LEAF(mem_alloc,         void *, (size_t size),                      (size))
+RTX_SVC_LEAF(mem_dealloc,       int,    (void *ptr),                        (ptr))
+RTX_SVC_LEAF(mem_count_extfrag, int,    (size_t size),                      (size))
+
+/* system initialization */
+RTX_SVC     (rtx_init,          int,    (RTX_TASK_INFO *tsk_info, int num_tasks), (tsk_info, num_tasks))
+RTX_SVC     (rtx_init_rt,       int,    (RTX_SYS_INFO *sys_info, RTX_TASK_INFO *task_info, int num_tasks),
+                                        (sys_info, task_info, num_tasks))
+RTX_SVC_LEAF(get_sys_info,      int,    (RTX_SYS_INFO *buffer),             (buffer))
+
+/* task management */
+RTX_SVC     (tsk_yield,         int,    (void),                             ())
+RTX_SVC     (tsk_create,        int,    (task_t *task, void (*task_entry)(void), U8 prio, U16 stack_size),
+                                        (task, task_entry, prio, stack_size))
+RTX_SVC     (tsk_exit,          void,   (void),                             ())
+RTX_SVC     (tsk_set_prio,      int,    (task_t task_id, U8 prio),          (task_id, prio))
+RTX_SVC_LEAF(tsk_get,           int,    (task_t task_id, RTX_TASK_INFO *buffer), (task_id, buffer))
+RTX_SVC_LEAF(tsk_ls,            int,    (task_t *buf, int count),           (buf, count))
+
+/* real-time tasks */
+RTX_SVC     (tsk_create_rt,     int,    (task_t *tid, TASK_RT *task),       (tid, task))
+RTX_SVC     (tsk_done_rt,       void,   (void),                             ())
+RTX_SVC     (tsk_suspend,       void,   (TIMEVAL *tv),                      (tv))
+
+/* interprocess communication */
+RTX_SVC     (mbx_create,        int,    (size_t size),                      (size))
+RTX_SVC     (mbx_create_prio,   int,    (size_t size, U32 num_classes),     (size, num_classes))
+RTX_SVC     (send_msg,          int,    (task_t tid, const void *buf),      (tid, buf))
+RTX_SVC     (recv_msg,          int,    (task_t *tid, void *buf, size_t len), (tid, buf, len))
+RTX_SVC_LEAF(recv_msg_nb,       int,    (task_t *tid, void *buf, size_t len), (tid, buf, len))
+RTX_SVC     (send_msg_timed,    int,    (task_t tid, const void *buf, TIMEVAL *tv), (tid, buf, tv))
+RTX_SVC     (recv_msg_timed,    int,    (task_t *tid, void *buf, size_t len, TIMEVAL *tv),
+                                        (tid, buf, len, tv))
+RTX_SVC     (recv_msg_batch,    int,    (task_t *tids, void *buf, size_t len, int max_msgs),
+                                        (tids, buf, len, max_msgs))
+RTX_SVC_LEAF(mbx_ls,            int,    (task_t *buf, int count),           (buf, count))
+
+/* statistics */
+RTX_SVC     (sys_snapshot,      int,    (RTX_SNAPSHOT *buf),                (buf))
+RTX_SVC_LEAF(tsk_get_pmu,       int,    (task_t tid, RTX_PMU_STAT *buf),    (tid, buf))
+RTX_SVC     (prof_start,        int,    (U32 hz),                           (hz))
+RTX_SVC     (prof_stop,         int,    (void),                             ())
+RTX_SVC_LEAF(prof_read,         int,    (RTX_PROF_SAMPLE *buf, int max),    (buf, max))
+
+/* timing service */
+RTX_SVC_LEAF(get_time,          int,    (TIMEVAL *tv),                      (tv))
+
+/* worker pool */
+RTX_SVC     (pool_create,       int,    (U32 num_workers, U8 prio, U16 stack_size),
+                                        (num_workers, prio, stack_size))
+RTX_SVC     (pool_submit,       int,    (void (*fn)(void *arg), void *arg), (fn, arg))
+RTX_SVC     (pool_take,         int,    (RTX_POOL_JOB *job),                (job))
+
+/*
+ *===========================================================================
+ *                             END OF FILE
+ *===========================================================================
+ */
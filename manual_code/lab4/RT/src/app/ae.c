@@ -105,6 +105,15 @@ void ae_set_task_info(RTX_TASK_INFO *tasks, int num_tasks) {
 		return;
 	}
 
+#ifdef AE_BENCH
+	ae_bench_set_task_info(tasks, num_tasks);
+	return;
+#endif
+#ifdef AE_LAT
+	ae_lat_set_task_info(tasks, num_tasks);
+	return;
+#endif
+
 	for (int i = 0; i < num_tasks; i++) {
 		tasks[i].u_stack_size = 0x200;
 		tasks[i].prio = 100;
@@ -34,6 +34,8 @@
 #include "rtx.h"
 #include "ae_priv_tasks.h"
 #include "ae_usr_tasks.h"
+#include "ae_bench.h"
+#include "ae_lat.h"
 
 /*
  *===========================================================================
@@ -0,0 +1,296 @@
+/*
+ ****************************************************************************
+ *
+ *                  UNIVERSITY OF WATERLOO ECE 350 RTOS LAB
+ *
+ *                     Copyright 2020-2021 Yiqing Huang
+ *                          All rights reserved.
+ *
+ *  Redistribution and use in source and binary forms, with or without
+ *  modification, are permitted provided that the following conditions are met:
+ *  - Redistributions of source code must retain the above copyright
+ *    notice and the following disclaimer.
+ *
+ *
+ *  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ *  AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ *  IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ *  ARE DISCLAIMED. IN NO EVENT SHALL COPYRIGHT HOLDERS AND CONTRIBUTORS BE
+ *  LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ *  CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ *  SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ *  INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ *  CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ *  ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ *  POSSIBILITY OF SUCH DAMAGE.
+ ****************************************************************************
+ */
+
+
+/**************************************************************************//**
+ * @file        ae_bench.c
+ * @brief       Message passing benchmark tasks
+ *
+ * @version     V1.2021.01
+ * @authors     Yiqing Huang
+ * @date        2021 JAN
+ *
+ * @details     bench_prod streams BENCH_NUM_MSGS 32-byte messages and a
+ *              BENCH_END to bench_cons once per run, blocking whenever the
+ *              mailbox is full. It starts a run only on a BENCH_GO from
+ *              bench_cons, which sends the next one after it has taken
+ *              the BENCH_END, so no two runs share the mailbox.
+ *              bench_cons times each run with the A9 private timer
+ *              and prints messages/s. bench_idle soaks up the cpu the pair
+ *              leaves, so a spinning producer or consumer shows up as a low
+ *              idle count.
+ *              Runs: recv_msg, recv_msg_batch, then two runs where every
+ *              BENCH_CTRL_EVERY-th message is a time-stamped control
+ *              message, first untagged (FIFO behind the bulk stream), then
+ *              tagged MSG_PRIO(1) so the priority mailbox delivers it first.
+ *              The last run, ctrl mixed, sends only bulk from bench_prod
+ *              while bench_ctrl, a task bench_cons creates for it, sends
+ *              BENCH_MIX_CTRL tagged control messages with plain send_msg
+ *              each time it finds bench_prod blocked on the full bulk
+ *              class. None of them may be dropped.
+ *              A run that did not get exactly its own messages is marked
+ *              "FAIL", its latencies would compare mixed runs.
+ *              Build with AE_BENCH defined to run these instead of the
+ *              default AE tasks.
+ *****************************************************************************/
+
+#include "ae_bench.h"
+#include "timer.h"
+#include "printf.h"
+
+#define BENCH_MSG_SIZE      32
+#define BENCH_MBX_SIZE      0x800   /* two classes of 0x400 */
+#define BENCH_BATCH         16      /* messages per recv_msg_batch call */
+#define BENCH_DATA          10      /* message types, user types start at 10 */
+#define BENCH_END           11
+#define BENCH_CTRL          12
+#define BENCH_GO            13      /* to bench_prod: start the next run */
+#define BENCH_GO_MBX_SIZE   0x40
+#define BENCH_CTRL_EVERY    100
+#define BENCH_MIX_CTRL      100     /* control messages of the ctrl mixed run */
+
+#define RUN_RECV            0
+#define RUN_BATCH           1
+#define RUN_CTRL_FIFO       2
+#define RUN_CTRL_PRIO       3
+#define RUN_CTRL_MIX        4
+#define BENCH_NUM_RUNS      5
+
+static char *g_method[BENCH_NUM_RUNS] = {
+	"recv_msg", "recv_msg_batch", "ctrl fifo", "ctrl prio", "ctrl mixed"
+};
+
+static volatile U32 g_idle_count;
+static volatile U32 g_mix_drops;        // bench_ctrl sends that failed
+
+/**************************************************************************//**
+ * @brief       producer and consumer share a priority so neither preempts
+ *              the other on every message; the idle task runs only when
+ *              both are blocked
+ *****************************************************************************/
+void ae_bench_set_task_info(RTX_TASK_INFO *tasks, int num_tasks) {
+
+	if (tasks == NULL || num_tasks < BENCH_NUM_TASKS) {
+		return;
+	}
+
+	for (int i = 0; i < num_tasks; i++) {
+		tasks[i].u_stack_size = 0x200;
+		tasks[i].priv = 0;
+	}
+	tasks[0].ptask = &bench_prod;
+	tasks[0].prio = MEDIUM;
+	tasks[1].ptask = &bench_cons;
+	tasks[1].prio = MEDIUM;
+	tasks[2].ptask = &bench_idle;
+	tasks[2].prio = LOWEST;
+}
+
+void bench_prod(void)
+{
+	U32 buf[BENCH_MSG_SIZE >> 2];
+	RTX_MSG_HDR *p_hdr = (RTX_MSG_HDR *) buf;
+	U32 *p_ts = (U32 *) (p_hdr + 1);
+	TIMEVAL tv;
+	task_t tid;
+
+	if (mbx_create(BENCH_GO_MBX_SIZE) < 0) {
+		printf("bench_prod: mbx_create failed\r\n");
+	}
+
+	for (int run = 0; run < BENCH_NUM_RUNS; run++) {
+		// wait until bench_cons has taken the last run and asks for this one
+		while (recv_msg(&tid, buf, sizeof(buf)) != RTX_OK ||
+		       MSG_TYPE_OF(p_hdr->type) != BENCH_GO) {
+			;
+		}
+		p_hdr->length = BENCH_MSG_SIZE;
+		for (int i = 0; i < BENCH_NUM_MSGS; i++) {
+			p_hdr->type = BENCH_DATA;
+			if ((run == RUN_CTRL_FIFO || run == RUN_CTRL_PRIO) &&
+			    i % BENCH_CTRL_EVERY == 0) {
+				p_hdr->type = BENCH_CTRL;
+				if (run == RUN_CTRL_PRIO) {
+					p_hdr->type |= MSG_PRIO(1);
+				}
+				*p_ts = timer_get_current_val(2);
+			}
+			send_msg_timed(BENCH_CONS_TID, buf, NULL);
+		}
+		p_hdr->type = BENCH_END;
+		send_msg_timed(BENCH_CONS_TID, buf, NULL);
+	}
+
+	tv.sec = 1;
+	tv.usec = 0;
+	while (1) {
+		tsk_suspend(&tv);
+	}
+}
+
+/**************************************************************************//**
+ * @brief       control sender of the ctrl mixed run, created by bench_cons
+ *              at the priority of bench_prod. It yields until bench_prod
+ *              is blocked sending bulk, then sends one tagged control
+ *              message without blocking; once bench_prod is done it sends
+ *              the rest right away. Ends with its own BENCH_END
+ *****************************************************************************/
+static void bench_ctrl(void)
+{
+	U32 buf[BENCH_MSG_SIZE >> 2];
+	RTX_MSG_HDR *p_hdr = (RTX_MSG_HDR *) buf;
+	U32 *p_body = (U32 *) (p_hdr + 1);
+	RTX_TASK_INFO info;
+
+	p_hdr->length = BENCH_MSG_SIZE;
+	for (int i = 0; i < BENCH_MIX_CTRL; i++) {
+		while (tsk_get(BENCH_PROD_TID, &info) == RTX_OK && info.state == READY) {
+			tsk_yield();
+		}
+		p_hdr->type = BENCH_CTRL | MSG_PRIO(1);
+		p_body[1] = (info.state == BLK_SEND);
+		p_body[0] = timer_get_current_val(2);
+		if (send_msg(BENCH_CONS_TID, buf) != RTX_OK) {
+			g_mix_drops++;
+		}
+		tsk_yield();
+	}
+	p_hdr->type = BENCH_END | MSG_PRIO(1);
+	send_msg_timed(BENCH_CONS_TID, buf, NULL);
+	tsk_exit();
+}
+
+void bench_cons(void)
+{
+	U32 buf[(BENCH_BATCH * BENCH_MSG_SIZE) >> 2];
+	task_t tids[BENCH_BATCH];
+	U32 go[BENCH_MSG_SIZE >> 2];
+	RTX_MSG_HDR *p_go = (RTX_MSG_HDR *) go;
+
+	if (mbx_create_prio(BENCH_MBX_SIZE, 2) < 0) {
+		printf("bench_cons: mbx_create failed\r\n");
+	}
+
+	p_go->length = BENCH_MSG_SIZE;
+	p_go->type = BENCH_GO;
+	for (int run = 0; run < BENCH_NUM_RUNS; run++) {
+		U32 n = 0;
+		U32 t0;
+		U32 us;
+		U32 idle0;
+		U32 n_ctrl = 0;
+		U32 n_ctrl_blk = 0;
+		U32 lat_sum = 0;
+		U32 lat_max = 0;
+		U32 n_ctrl_exp = (run >= RUN_CTRL_FIFO) ? BENCH_NUM_MSGS / BENCH_CTRL_EVERY : 0;
+		U32 n_exp = BENCH_NUM_MSGS;
+		U32 n_end = 0;
+		U32 n_end_exp = 1;
+		task_t ctrl_tid;
+
+		t0 = timer_get_current_val(2);
+		idle0 = g_idle_count;
+		send_msg(BENCH_PROD_TID, go);
+		if (run == RUN_CTRL_MIX) {
+			n_ctrl_exp = BENCH_MIX_CTRL;
+			n_exp = BENCH_NUM_MSGS + BENCH_MIX_CTRL;
+			n_end_exp = 2;
+			g_mix_drops = 0;
+			if (tsk_create(&ctrl_tid, bench_ctrl, MEDIUM, 0x200) != RTX_OK) {
+				printf("bench_cons: tsk_create failed\r\n");
+				n_end_exp = 1;
+			}
+		}
+		while (n_end < n_end_exp) {
+			RTX_MSG_HDR *p_hdr = (RTX_MSG_HDR *) buf;
+			int cnt;
+
+			if (run != RUN_BATCH) {
+				cnt = (recv_msg(tids, buf, sizeof(buf)) == RTX_OK) ? 1 : 0;
+			} else {
+				cnt = recv_msg_batch(tids, buf, sizeof(buf), BENCH_BATCH);
+			}
+			for (int i = 0; i < cnt && n_end < n_end_exp; i++) {
+				U32 type = MSG_TYPE_OF(p_hdr->type);
+
+				if (type == BENCH_END) {
+					n_end++;        // the last message, bench_prod waits for a GO
+				} else {
+					n++;
+				}
+				if (type == BENCH_CTRL) {
+					U32 lat = *(U32 *) (p_hdr + 1) - timer_get_current_val(2);
+
+					lat_sum += lat;
+					lat_max = (lat > lat_max) ? lat : lat_max;
+					n_ctrl++;
+					if (run == RUN_CTRL_MIX) {
+						n_ctrl_blk += ((U32 *) (p_hdr + 1))[1];
+					}
+				}
+				p_hdr = MSG_BATCH_NEXT(p_hdr);
+			}
+		}
+
+		// the A9 private timer counts down once every microsecond
+		us = t0 - timer_get_current_val(2);
+		printf("%s: %u msgs in %u us, %u msgs/s, idle %u\r\n",
+		       g_method[run], n, us,
+		       (U32) (((unsigned long long) n * 1000000U) / (us ? us : 1)),
+		       g_idle_count - idle0);
+		if (n != n_exp || n_ctrl != n_ctrl_exp) {
+			printf("%s: FAIL, expected %u msgs and %u ctrl msgs\r\n",
+			       g_method[run], n_exp, n_ctrl_exp);
+		}
+		if (run == RUN_CTRL_MIX) {
+			printf("%s: %u ctrl msgs sent while the bulk sender was blocked, %u dropped\r\n",
+			       g_method[run], n_ctrl_blk, g_mix_drops);
+		}
+		if (n_ctrl > 0) {
+			printf("%s: ctrl latency avg %u us, max %u us over %u msgs\r\n",
+			       g_method[run], lat_sum / n_ctrl, lat_max, n_ctrl);
+		}
+	}
+
+	while (1) {
+		recv_msg(tids, buf, sizeof(buf));
+	}
+}
+
+void bench_idle(void)
+{
+	while (1) {
+		g_idle_count++;
+	}
+}
+
+/*
+ *===========================================================================
+ *                             END OF FILE
+ *===========================================================================
+ */
@@ -0,0 +1,497 @@
+/*
+ ****************************************************************************
+ *
+ *                  UNIVERSITY OF WATERLOO ECE 350 RTOS LAB
+ *
+ *                     Copyright 2020-2021 Yiqing Huang
+ *                          All rights reserved.
+ *
+ *  Redistribution and use in source and binary forms, with or without
+ *  modification, are permitted provided that the following conditions are met:
+ *  - Redistributions of source code must retain the above copyright
+ *    notice and the following disclaimer.
+ *
+ *
+ *  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ *  AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ *  IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ *  ARE DISCLAIMED. IN NO EVENT SHALL COPYRIGHT HOLDERS AND CONTRIBUTORS BE
+ *  LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ *  CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ *  SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ *  INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ *  CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ *  ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ *  POSSIBILITY OF SUCH DAMAGE.
+ ****************************************************************************
+ */
+
+/**************************************************************************//**
+ * @file        ae_lat.c
+ * @brief       Kernel latency benchmark tasks
+ *
+ * @version     V1.2021.01
+ * @authors     Yiqing Huang
+ * @date        2021 JAN
+ *
+ * @details     Rhealstone style latency tests, LAT_ITER samples each:
+ *              syscall     recv_msg_nb on an empty mailbox, a kernel
+ *                          round trip without a switch, leaf SVC path
+ *              syscall_full
+ *                          mbx_create of a second mailbox, fails at once
+ *                          but takes the full SVC frame path
+ *              syscall_bad an SVC number past the table, must fail with
+ *                          RTX_ERR before any kernel function runs;
+ *                          "FAIL" in the samples column if it did not
+ *              yield       tsk_yield between two equal priority tasks,
+ *                          half a round trip, i.e. one switch
+ *              preempt     send_msg to a blocked higher priority task
+ *                          until it returns from recv_msg
+ *              send_recv   send_msg to a higher priority task that replies,
+ *                          until the reply is received
+ *              mem_alloc   mem_alloc of LAT_ALLOC_SIZE bytes
+ *              mem_dealloc mem_dealloc of the same block
+ *              irq         SGI raised by a task until its handler runs
+ *              ping_pong   send_msg/recv_msg shuffle between two equal
+ *                          priority tasks, one round trip
+ *              churn       tsk_create of a higher priority task that
+ *                          exits at once, until the creator runs again;
+ *                          LAT_CHURN samples, "FAIL" if a create failed
+ *              pool        pool_submit of an empty job to a higher
+ *                          priority worker, until the submitter runs
+ *                          again; LAT_CHURN samples, "FAIL" if a job was
+ *                          lost. The same work as churn without the task
+ *              churn_rate, pool_rate
+ *                          jobs per million cycles of the two (avg only)
+ *              prof_off, prof_on
+ *                          a fixed busy loop of LAT_PROF_WORK iterations,
+ *                          LAT_PROF_RUNS samples each, alternately with
+ *                          the profiler off and sampling at LAT_PROF_HZ
+ *              prof_overhead
+ *                          extra time of prof_on over prof_off in parts
+ *                          per million (avg only); "FAIL" if prof_start
+ *                          was refused, as with RT_TIMER_FIQ. In the host
+ *                          port Linux scheduling noise swamps it
+ *              Times are PMU cycle counts, so the tests only depend on
+ *              CP15 and the GIC and read the same on any Cortex-A9 board.
+ *              Results come out as one CSV table, lines prefixed "LAT,",
+ *              so that runs of two kernel builds can be diffed.
+ *              Build with AE_LAT defined to run these instead of the
+ *              default AE tasks. The "LAT,build" line records whether
+ *              the hot paths ran from OCRAM (KERN_OCRAM) and whether the
+ *              instruction cache was on (KERN_ICACHE), so the four
+ *              combinations can be told apart in the results. The data
+ *              cache is off in all of them, it needs the MMU.
+ *****************************************************************************/
+
+#include "ae_lat.h"
+#include "interrupt.h"
+#include "printf.h"
+
+#define LAT_SGI_ID          1       /* SGI 0 is the kernel doorbell */
+#define LAT_ALLOC_SIZE      64
+#define LAT_MBX_SIZE        0x100
+#define LAT_PROF_HZ         1000
+#define LAT_PROF_RUNS       50
+#define LAT_PROF_WORK       1000000     /* busy loop iterations, several ms */
+
+/* message types, user types start at 10 */
+#define LAT_YIELD           10      /* peer: yield LAT_ITER times */
+#define LAT_PONG            11      /* peer: reply to every message */
+#define LAT_PREEMPT         12      /* hi: time the wakeup */
+#define LAT_ECHO            13      /* hi: reply */
+
+#ifdef KERN_OCRAM
+#define LAT_OCRAM           1
+#else
+#define LAT_OCRAM           0
+#endif
+#ifdef KERN_ICACHE
+#define LAT_ICACHE          1
+#else
+#define LAT_ICACHE          0
+#endif
+
+typedef struct lat_msg {
+	RTX_MSG_HDR hdr;
+	U32         ts;                 /* cycle count when sent */
+} LAT_MSG;
+
+typedef struct lat_stat {
+	U32                 n;
+	U32                 min;
+	U32                 max;
+	unsigned long long  sum;
+} LAT_STAT;
+
+static volatile U32 g_lat_ts;       /* written by lat_hi and the SGI handler */
+
+/* an SVC number no system call has */
+#define LAT_SVC_BAD         0xFF
+
+#if defined(RTX_HOST)
+#define lat_svc_bad()       host_svc(LAT_SVC_BAD)
+#elif defined(__CC_ARM)
+extern int __svc(LAT_SVC_BAD) lat_svc_bad(void);
+#else
+static __inline int lat_svc_bad(void)
+{
+	register int rc __asm("r0");
+
+	/* LR_SVC is lost to the SVC, lat_main runs in SVC mode */
+	__asm volatile ("push {r4, lr}\n\tsvc %1\n\tpop {r4, lr}"
+	                : "=r" (rc) : "i" (LAT_SVC_BAD) : "r1", "r2", "r3", "r12", "memory");
+	return rc;
+}
+#endif
+
+/**************************************************************************//**
+ * @brief       read the PMU cycle counter, enabled for USR mode by the kernel
+ * @note        host nanoseconds in the host port
+ *****************************************************************************/
+static __inline U32 lat_cycles(void)
+{
+#ifdef RTX_HOST
+	return (U32) host_clock_ns();
+#elif defined(__CC_ARM)
+	register U32 ccnt __asm("cp15:0:c9:c13:0");
+
+	return ccnt;
+#else
+	U32 ccnt;
+
+	__asm volatile ("mrc p15, 0, %0, c9, c13, 0" : "=r" (ccnt));
+	return ccnt;
+#endif
+}
+
+static void lat_reset(LAT_STAT *p_stat)
+{
+	p_stat->n = 0;
+	p_stat->min = 0xFFFFFFFF;
+	p_stat->max = 0;
+	p_stat->sum = 0;
+}
+
+static void lat_add(LAT_STAT *p_stat, U32 cycles)
+{
+	p_stat->n++;
+	p_stat->sum += cycles;
+	p_stat->min = (cycles < p_stat->min) ? cycles : p_stat->min;
+	p_stat->max = (cycles > p_stat->max) ? cycles : p_stat->max;
+}
+
+static void lat_print(const char *name, LAT_STAT *p_stat)
+{
+	printf("LAT,%s,%u,%u,%u,%u\r\n", name, p_stat->n, p_stat->min,
+	       (U32) (p_stat->sum / (p_stat->n ? p_stat->n : 1)), p_stat->max);
+}
+
+static int lat_send(task_t tid, U32 type)
+{
+	LAT_MSG msg;
+
+	msg.hdr.length = sizeof(msg);
+	msg.hdr.type = type;
+	msg.ts = lat_cycles();
+	return send_msg(tid, &msg);
+}
+
+/* the short-lived task of the churn test */
+static void lat_child(void)
+{
+	tsk_exit();
+}
+
+/* the job of the pool test */
+static void lat_job(void *arg)
+{
+	(*(volatile U32 *) arg)++;
+}
+
+/* jobs per million cycles at the average of p_stat */
+static U32 lat_rate(LAT_STAT *p_stat)
+{
+	return (U32) ((1000000ULL * p_stat->n) / (p_stat->sum ? p_stat->sum : 1));
+}
+
+/* one run of the profiler test, the caller unmasks IRQs */
+static U32 lat_work(void)
+{
+	volatile U32 n = 0;
+	U32 t0 = lat_cycles();
+
+	for (int i = 0; i < LAT_PROF_WORK; i++) {
+		n++;
+	}
+	return lat_cycles() - t0;
+}
+
+/*
+ * LAT_PROF_RUNS pairs of lat_work runs, profiler off then on, so that drift
+ * over the test hits both alike. The samples are drained between runs
+ */
+static int lat_prof_runs(LAT_STAT *p_off, LAT_STAT *p_on)
+{
+	RTX_PROF_SAMPLE smp[8];
+
+	lat_reset(p_off);
+	lat_reset(p_on);
+	lat_work();                     // warm up
+	for (int i = 0; i < LAT_PROF_RUNS; i++) {
+		__enable_irq();             // a privileged task runs with IRQs masked
+		lat_add(p_off, lat_work());
+		__disable_irq();
+		if (prof_start(LAT_PROF_HZ) != RTX_OK) {
+			return RTX_ERR;
+		}
+		__enable_irq();
+		lat_add(p_on, lat_work());
+		__disable_irq();
+		prof_stop();
+		while (prof_read(smp, 8) > 0) {
+			;
+		}
+	}
+	return RTX_OK;
+}
+
+static U32 lat_irq(U32 irq_id, void *arg)
+{
+	g_lat_ts = lat_cycles();
+	return IRQ_DONE;
+}
+
+/**************************************************************************//**
+ * @brief       lat_main and lat_peer share a priority for the yield and
+ *              ping-pong tests, lat_hi outranks both. lat_main is
+ *              privileged to install the SGI handler
+ *****************************************************************************/
+void ae_lat_set_task_info(RTX_TASK_INFO *tasks, int num_tasks) {
+
+	if (tasks == NULL || num_tasks < LAT_NUM_TASKS) {
+		return;
+	}
+
+	for (int i = 0; i < num_tasks; i++) {
+		tasks[i].u_stack_size = 0x200;
+		tasks[i].priv = 0;
+	}
+	tasks[0].ptask = &lat_main;
+	tasks[0].prio = MEDIUM;
+	tasks[0].priv = 1;
+	tasks[1].ptask = &lat_peer;
+	tasks[1].prio = MEDIUM;
+	tasks[2].ptask = &lat_hi;
+	tasks[2].prio = HIGH;
+}
+
+void lat_main(void)
+{
+	LAT_MSG msg;
+	LAT_STAT stat;
+	LAT_STAT stat_free;
+	task_t tid;
+	U32 churn_rate;
+	volatile U32 jobs;
+	int rc;
+
+	mbx_create(LAT_MBX_SIZE);
+	irq_register(LAT_SGI_ID, lat_irq, NULL);
+	GIC_SetPriority(LAT_SGI_ID, IRQ_PRIO_UART0);
+	tsk_yield();                    // let lat_peer create its mailbox
+
+	printf("LAT,build,ocram=%d,icache=%d\r\n", LAT_OCRAM, LAT_ICACHE);
+	printf("LAT,test,samples,min,avg,max\r\n");
+
+	lat_reset(&stat);
+	for (int i = 0; i < LAT_ITER; i++) {
+		U32 t0 = lat_cycles();
+
+		recv_msg_nb(&tid, &msg, sizeof(msg));
+		lat_add(&stat, lat_cycles() - t0);
+	}
+	lat_print("syscall", &stat);
+
+	lat_reset(&stat);
+	for (int i = 0; i < LAT_ITER; i++) {
+		U32 t0 = lat_cycles();
+
+		mbx_create(LAT_MBX_SIZE);
+		lat_add(&stat, lat_cycles() - t0);
+	}
+	lat_print("syscall_full", &stat);
+
+	lat_reset(&stat);
+	rc = RTX_ERR;
+	for (int i = 0; i < LAT_ITER && rc == RTX_ERR; i++) {
+		U32 t0 = lat_cycles();
+
+		rc = lat_svc_bad();
+		lat_add(&stat, lat_cycles() - t0);
+	}
+	if (rc == RTX_ERR) {
+		lat_print("syscall_bad", &stat);
+	} else {
+		printf("LAT,syscall_bad,FAIL,,,\r\n");
+	}
+
+	lat_reset(&stat);
+	lat_send(LAT_PEER_TID, LAT_YIELD);
+	for (int i = 0; i < LAT_ITER; i++) {
+		U32 t0 = lat_cycles();
+
+		tsk_yield();
+		lat_add(&stat, (lat_cycles() - t0) / 2);
+	}
+	tsk_yield();                    // lat_peer goes back to recv_msg
+	lat_print("yield", &stat);
+
+	lat_reset(&stat);
+	for (int i = 0; i < LAT_ITER; i++) {
+		lat_send(LAT_HI_TID, LAT_PREEMPT);
+		lat_add(&stat, g_lat_ts);
+	}
+	lat_print("preempt", &stat);
+
+	lat_reset(&stat);
+	for (int i = 0; i < LAT_ITER; i++) {
+		U32 t0 = lat_cycles();
+
+		lat_send(LAT_HI_TID, LAT_ECHO);
+		recv_msg(&tid, &msg, sizeof(msg));
+		lat_add(&stat, lat_cycles() - t0);
+	}
+	lat_print("send_recv", &stat);
+
+	lat_reset(&stat);
+	lat_reset(&stat_free);
+	for (int i = 0; i < LAT_ITER; i++) {
+		U32 t0 = lat_cycles();
+		void *p_blk = mem_alloc(LAT_ALLOC_SIZE);
+		U32 t1 = lat_cycles();
+
+		mem_dealloc(p_blk);
+		lat_add(&stat, t1 - t0);
+		lat_add(&stat_free, lat_cycles() - t1);
+	}
+	lat_print("mem_alloc", &stat);
+	lat_print("mem_dealloc", &stat_free);
+
+	lat_reset(&stat);
+	__enable_irq();                 // a privileged task runs with IRQs masked
+	for (int i = 0; i < LAT_ITER; i++) {
+		U32 t0 = lat_cycles();
+
+		g_lat_ts = t0;
+		irq_raise_sgi(LAT_SGI_ID);
+		while (g_lat_ts == t0) {
+			;                       // taken right away unless masked
+		}
+		lat_add(&stat, g_lat_ts - t0);
+	}
+	__disable_irq();
+	lat_print("irq", &stat);
+
+	lat_reset(&stat);
+	for (int i = 0; i < LAT_ITER; i++) {
+		U32 t0 = lat_cycles();
+
+		lat_send(LAT_PEER_TID, LAT_PONG);
+		recv_msg(&tid, &msg, sizeof(msg));
+		lat_add(&stat, lat_cycles() - t0);
+	}
+	lat_print("ping_pong", &stat);
+
+	lat_reset(&stat);
+	rc = RTX_OK;
+	for (int i = 0; i < LAT_CHURN && rc == RTX_OK; i++) {
+		U32 t0 = lat_cycles();
+
+		rc = tsk_create(&tid, lat_child, HIGH, 0x200);
+		lat_add(&stat, lat_cycles() - t0);
+	}
+	if (rc == RTX_OK) {
+		lat_print("churn", &stat);
+	} else {
+		printf("LAT,churn,FAIL,,,\r\n");
+	}
+	churn_rate = lat_rate(&stat);
+
+	lat_reset(&stat);
+	jobs = 0;
+	rc = pool_create(1, HIGH, 0x200);
+	for (int i = 0; i < LAT_CHURN && rc == RTX_OK; i++) {
+		U32 t0 = lat_cycles();
+
+		rc = pool_submit(lat_job, (void *) &jobs);
+		lat_add(&stat, lat_cycles() - t0);
+	}
+	if (rc == RTX_OK && jobs == LAT_CHURN) {
+		lat_print("pool", &stat);
+	} else {
+		printf("LAT,pool,FAIL,,,\r\n");
+	}
+	printf("LAT,churn_rate,%u,,%u,\r\n", LAT_CHURN, churn_rate);
+	printf("LAT,pool_rate,%u,,%u,\r\n", LAT_CHURN, lat_rate(&stat));
+
+	if (lat_prof_runs(&stat_free, &stat) == RTX_OK) {
+		U64 off = stat_free.sum;
+
+		lat_print("prof_off", &stat_free);
+		lat_print("prof_on", &stat);
+		printf("LAT,prof_overhead,%u,,%d,\r\n", LAT_PROF_RUNS,
+		       (int) ((1000000LL * ((S64) stat.sum - (S64) off)) / (S64) (off ? off : 1)));
+	} else {
+		printf("LAT,prof_overhead,FAIL,,,\r\n");
+	}
+	printf("LAT,done\r\n");
+
+	while (1) {
+		recv_msg(&tid, &msg, sizeof(msg));
+	}
+}
+
+void lat_peer(void)
+{
+	LAT_MSG msg;
+	task_t tid;
+
+	mbx_create(LAT_MBX_SIZE);
+	while (1) {
+		if (recv_msg(&tid, &msg, sizeof(msg)) != RTX_OK) {
+			continue;
+		}
+		if (msg.hdr.type == LAT_YIELD) {
+			for (int i = 0; i < LAT_ITER; i++) {
+				tsk_yield();
+			}
+		} else if (msg.hdr.type == LAT_PONG) {
+			lat_send(tid, LAT_PONG);
+		}
+	}
+}
+
+void lat_hi(void)
+{
+	LAT_MSG msg;
+	task_t tid;
+
+	mbx_create(LAT_MBX_SIZE);
+	while (1) {
+		if (recv_msg(&tid, &msg, sizeof(msg)) != RTX_OK) {
+			continue;
+		}
+		if (msg.hdr.type == LAT_PREEMPT) {
+			g_lat_ts = lat_cycles() - msg.ts;
+		} else if (msg.hdr.type == LAT_ECHO) {
+			lat_send(tid, LAT_ECHO);
+		}
+	}
+}
+
+/*
+ *===========================================================================
+ *                             END OF FILE
+ *===========================================================================
+ */
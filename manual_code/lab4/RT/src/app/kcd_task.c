@@ -1,6 +1,315 @@
-/* The KCD Task Template File */
+/*
+ ****************************************************************************
+ *
+ *                  UNIVERSITY OF WATERLOO ECE 350 RTOS LAB
+ *
+ *                     Copyright 2020-2021 Yiqing Huang
+ *                          All rights reserved.
+ *
+ *  Redistribution and use in source and binary forms, with or without
+ *  modification, are permitted provided that the following conditions are met:
+ *  - Redistributions of source code must retain the above copyright
+ *    notice and the following disclaimer.
+ *
+ *
+ *  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ *  AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ *  IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ *  ARE DISCLAIMED. IN NO EVENT SHALL COPYRIGHT HOLDERS AND CONTRIBUTORS BE
+ *  LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ *  CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ *  SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ *  INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ *  CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ *  ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ *  POSSIBILITY OF SUCH DAMAGE.
+ ****************************************************************************
+ */
+
+/**************************************************************************//**
+ * @file        kcd_task.c
+ * @brief       Keyboard Command Decoder (KCD) task
+ *
+ * @version     V1.2021.01
+ * @authors     Yiqing Huang
+ * @date        2021 JAN
+ *
+ * @details     Collects KEY_IN characters into a command line and, on Enter,
+ *              either runs a built-in command or forwards the command to
+ *              the task that registered its identifier with KCD_REG.
+ *              Built-in commands:
+ *                %LT   list tasks     (tid, state, prio, CPU %, stack high-water)
+ *                %LM   list mailboxes (tid, used/free bytes, msgs, drops)
+ *                %PS   start the PC sampling profiler at KCD_PROF_HZ
+ *                %PX   stop it
+ *                %PD   dump the samples, one "PROF,pc,mode,tid" line each,
+ *                      for tools/prof.py
+ *              Statistics are read with one sys_snapshot() call and
+ *              formatted afterwards, so listing never holds off interrupts
+ *              longer than the snapshot itself. All output goes to the
+ *              console as DISPLAY messages.
+ *
+ *****************************************************************************/
+
+#include "rtx.h"
+#include "printf.h"
+
+/*
+ *===========================================================================
+ *                             MACROS
+ *===========================================================================
+ */
+
+#define KCD_NUM_IDS     128         /* one slot per 7-bit command identifier */
+#define KCD_MSG_SIZE    (sizeof(RTX_MSG_HDR) + KCD_CMD_BUF_SIZE)
+#define KCD_PROF_HZ     1000
+#define KCD_PROF_CHUNK  16          /* samples per prof_read call */
+
+/*
+ *===========================================================================
+ *                            GLOBAL VARIABLES
+ *===========================================================================
+ */
+
+static task_t       g_cmd_tid[KCD_NUM_IDS];     // registered handler per identifier, TID_NULL = none
+static char         g_cmd_buf[KCD_CMD_BUF_SIZE];// command line being typed
+static int          g_cmd_len;                  // number of chars in g_cmd_buf
+static BOOL         g_cmd_overflow;             // command line was too long
+static RTX_SNAPSHOT g_snap;                     // last kernel snapshot
+static U32          g_snap_ts = 0xFFFFFFFF;     // timestamp of the previous %LT, timer starts full
+static U32          g_snap_run[MAX_TASKS];      // run time of each task at the previous %LT
+
+/*
+ *===========================================================================
+ *                            FUNCTIONS
+ *===========================================================================
+ */
+
+static size_t kcd_strlen(const char *s)
+{
+	size_t n = 0;
+	while (s[n] != '\0') {
+		n++;
+	}
+	return n;
+}
+
+/**
+ * @brief   send one line of text to the console
+ * @param   wait    TRUE to wait for room in the console mailbox,
+ *                  FALSE to drop the line if the mailbox is full
+ * @return  RTX_OK on success, RTX_ERR if the line was dropped
+ */
+static int kcd_put(const char *str, BOOL wait)
+{
+	U8 buf[sizeof(RTX_MSG_HDR) + KCD_LINE_SIZE];
+	RTX_MSG_HDR *p_hdr = (RTX_MSG_HDR *) buf;
+	char *p_data = (char *) (buf + sizeof(RTX_MSG_HDR));
+	size_t len = kcd_strlen(str);
+
+	if (len > KCD_LINE_SIZE) {
+		len = KCD_LINE_SIZE;
+	}
+	for (size_t i = 0; i < len; i++) {
+		p_data[i] = str[i];
+	}
+	p_hdr->length = sizeof(RTX_MSG_HDR) + len;
+	p_hdr->type = DISPLAY;
+	return wait ? send_msg_timed(TID_UART_IRQ, buf, NULL) : send_msg(TID_UART_IRQ, buf);
+}
+
+static int kcd_display(const char *str)
+{
+	return kcd_put(str, FALSE);
+}
+
+static char *kcd_state_str(U8 state)
+{
+	switch (state) {
+	case READY:
+		return "READY";
+	case RUNNING:
+		return "RUNNING";
+	case BLK_MSG:
+		return "BLK_MSG";
+	case BLK_SEND:
+		return "BLK_SEND";
+	case BLK_POOL:
+		return "BLK_POOL";
+	case SUSPENDED:
+		return "SUSPEND";
+	default:
+		return "?";
+	}
+}
+
+/**
+ * @brief   %LT, list all non-dormant tasks
+ * @note    CPU % is measured over the interval since the previous %LT.
+ *          Waits for room in the console mailbox rather than drop lines
+ */
+static void kcd_list_tasks(void)
+{
+	char line[KCD_LINE_SIZE];
+	U32 elapsed;
+
+	if (sys_snapshot(&g_snap) != RTX_OK) {
+		kcd_display("Snapshot failed\r\n");
+		return;
+	}
+	elapsed = (g_snap_ts - g_snap.timestamp) / 100;   // 1% of the interval
+	g_snap_ts = g_snap.timestamp;
+
+	kcd_put("TID STATE    PRIO CPU% KSTK USTK\r\n", TRUE);
+	for (int i = 0; i < g_snap.num_tasks; i++) {
+		RTX_TASK_STAT *p_stat = &g_snap.tasks[i];
+		U32 run = p_stat->run_time - g_snap_run[p_stat->tid];
+		U32 pct = (elapsed == 0) ? 0 : run / elapsed;
+
+		g_snap_run[p_stat->tid] = p_stat->run_time;
+		sprintf(line, "%3d %-8s %4d %3d%% %4d %4d\r\n", p_stat->tid,
+		        kcd_state_str(p_stat->state), p_stat->prio, pct,
+		        p_stat->k_stack_used, p_stat->u_stack_used);
+		kcd_put(line, TRUE);
+	}
+}
+
+/**
+ * @brief   %LM, list all mailboxes
+ * @note    waits for room in the console mailbox rather than drop lines
+ */
+static void kcd_list_mbx(void)
+{
+	char line[KCD_LINE_SIZE];
+
+	if (sys_snapshot(&g_snap) != RTX_OK) {
+		kcd_display("Snapshot failed\r\n");
+		return;
+	}
+
+	kcd_put("TID  USED  FREE MSGS DROPS\r\n", TRUE);
+	for (int i = 0; i < g_snap.num_mbx; i++) {
+		RTX_MBX_INFO *p_mbx = &g_snap.mbx[i];
+
+		sprintf(line, "%3d %5d %5d %4d %5d\r\n", p_mbx->tid, p_mbx->used,
+		        p_mbx->size - p_mbx->used, p_mbx->count, p_mbx->drops);
+		kcd_put(line, TRUE);
+	}
+}
+
+/**
+ * @brief   %PD, dump the profiler samples taken so far
+ * @note    waits for room in the console mailbox rather than drop lines
+ */
+static void kcd_prof_dump(void)
+{
+	RTX_PROF_SAMPLE smp[KCD_PROF_CHUNK];
+	char line[KCD_LINE_SIZE];
+	int n;
+
+	while ((n = prof_read(smp, KCD_PROF_CHUNK)) > 0) {
+		for (int i = 0; i < n; i++) {
+			sprintf(line, "PROF,%08x,%02x,%d\r\n", smp[i].pc, smp[i].mode, smp[i].tid);
+			kcd_put(line, TRUE);
+		}
+	}
+	kcd_put("PROF,end\r\n", TRUE);
+}
+
+/**
+ * @brief   forward a command to the task registered for its identifier
+ * @note    the message body is the command without the '%' prefix
+ */
+static void kcd_forward(void)
+{
+	U8 buf[KCD_MSG_SIZE];
+	RTX_MSG_HDR *p_hdr = (RTX_MSG_HDR *) buf;
+	char *p_data = (char *) (buf + sizeof(RTX_MSG_HDR));
+	RTX_TASK_INFO info;
+	task_t tid = g_cmd_tid[(U8) g_cmd_buf[1] & (KCD_NUM_IDS - 1)];
+
+	if (tid == TID_NULL || tsk_get(tid, &info) != RTX_OK) {
+		kcd_display("Command not found\r\n");
+		return;
+	}
+
+	for (int i = 1; i < g_cmd_len; i++) {
+		p_data[i - 1] = g_cmd_buf[i];
+	}
+	p_hdr->length = sizeof(RTX_MSG_HDR) + g_cmd_len - 1;
+	p_hdr->type = KCD_CMD;
+	if (send_msg(tid, buf) != RTX_OK) {
+		kcd_display("Command cannot be processed\r\n");
+	}
+}
+
+static BOOL kcd_is_cmd(const char *name)
+{
+	return g_cmd_len == 3 && g_cmd_buf[1] == name[0] && g_cmd_buf[2] == name[1];
+}
+
+static void kcd_run_cmd(void)
+{
+	char line[KCD_LINE_SIZE];
+
+	if (g_cmd_overflow || g_cmd_len < 2 || g_cmd_buf[0] != KCD_CMD_PREFIX) {
+		kcd_display("Command cannot be processed\r\n");
+	} else if (kcd_is_cmd("LT")) {
+		kcd_list_tasks();
+	} else if (kcd_is_cmd("LM")) {
+		kcd_list_mbx();
+	} else if (kcd_is_cmd("PS")) {
+		kcd_display((prof_start(KCD_PROF_HZ) == RTX_OK) ? "Profiling\r\n" : "Profiler unavailable\r\n");
+	} else if (kcd_is_cmd("PX")) {
+		sprintf(line, "Profiler stopped, %d samples dropped\r\n", prof_stop());
+		kcd_display(line);
+	} else if (kcd_is_cmd("PD")) {
+		kcd_prof_dump();
+	} else {
+		kcd_forward();
+	}
+	g_cmd_len = 0;
+	g_cmd_overflow = FALSE;
+}
+
+static void kcd_key_in(char c)
+{
+	if (c == '\r' || c == '\n') {
+		kcd_run_cmd();
+	} else if (g_cmd_len < KCD_CMD_BUF_SIZE) {
+		g_cmd_buf[g_cmd_len++] = c;
+	} else {
+		g_cmd_overflow = TRUE;
+	}
+}
 
 void kcd_task(void)
 {
-    /* not implemented yet */
+	U8 buf[KCD_MSG_SIZE];
+	RTX_MSG_HDR *p_hdr = (RTX_MSG_HDR *) buf;
+	char *p_data = (char *) (buf + sizeof(RTX_MSG_HDR));
+	task_t sender;
+
+	if (mbx_create(KCD_MBX_SIZE) < 0) {
+		tsk_exit();
+	}
+
+	while (1) {
+		if (recv_msg(&sender, buf, sizeof(buf)) != RTX_OK) {
+			continue;
+		}
+		if (p_hdr->type == KCD_REG && p_hdr->length > sizeof(RTX_MSG_HDR)) {
+			g_cmd_tid[(U8) p_data[0] & (KCD_NUM_IDS - 1)] = sender;
+		} else if (p_hdr->type == KEY_IN) {
+			for (U32 i = sizeof(RTX_MSG_HDR); i < p_hdr->length; i++) {
+				kcd_key_in(p_data[i - sizeof(RTX_MSG_HDR)]);
+			}
+		}
+	}
 }
+
+/*
+ *===========================================================================
+ *                             END OF FILE
+ *===========================================================================
+ */
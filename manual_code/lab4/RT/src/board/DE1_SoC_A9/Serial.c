@@ -201,3 +201,32 @@ char UART0_GetRxData(void)
 {
 	return UART0->UARTDR & 0xFF;
 }
+
+/*----------------------------------------------------------------------------
+  Read the pending interrupt type, reading IIR clears a tx-empty interrupt
+ *----------------------------------------------------------------------------*/
+int UART0_GetIRQType(void)
+{
+	return UART0->UART_IIR_FCR & 0xF;
+}
+
+/*----------------------------------------------------------------------------
+  Enable/disable the transmit holding register empty interrupt
+ *----------------------------------------------------------------------------*/
+void UART0_EnableTxIRQ(void)
+{
+	UART0->UARTIER_DLH |= 0x2;
+}
+
+void UART0_DisableTxIRQ(void)
+{
+	UART0->UARTIER_DLH &= ~0x2;
+}
+
+/*----------------------------------------------------------------------------
+  Write one character to the tx FIFO without waiting, caller tracks room
+ *----------------------------------------------------------------------------*/
+void UART0_PutTxData(char c)
+{
+	UART0->UARTDR = c;
+}
@@ -73,6 +73,11 @@ typedef struct {
 #define JTAG_UART	                ((JTAG_UART_Type *)JTAG_UART_BASE)
 
 #define UART0_CLK                       100000000 // L4_SP = 100MHz
+#define UART0_TX_FIFO_SIZE              128       // tx FIFO depth in bytes
+
+/* UART0 interrupt types, IIR[3:0] */
+#define UART0_IRQ_TX_EMPTY              0x2       // transmit holding register empty
+#define UART0_IRQ_RX_DATA               0x4       // received data available
 
 /* ECE350 START */
 #define BIT(X)                          ( 1 << (X) )
@@ -94,6 +99,10 @@ char JTAG_UART_GetChar(void);
 extern int UART0_GetRxIRQStatus(void);
 extern int UART0_GetRxDataStatus(void);
 extern char UART0_GetRxData(void);
+extern int  UART0_GetIRQType(void);
+extern void UART0_EnableTxIRQ(void);
+extern void UART0_DisableTxIRQ(void);
+extern void UART0_PutTxData(char c);
 
 extern void putc(void *p, char c);     /* call back function for printf, use JTAG UART */
 
@@ -46,12 +46,37 @@
 #define	HPS_TIMER0_IRQ_ID 199
 #define	HPS_TIMER1_IRQ_ID 200
 
+#define GIC_NUM_IRQS	256		/* dispatch table size, covers every source used */
+#define GIC_SPURIOUS_ID	1023	/* IAR value when no interrupt is pending */
+#define KERN_SGI_ID		0		/* doorbell an FIQ handler rings to reach the kernel */
+
+/* GIC priorities, lower values preempt higher ones. The A9 GIC implements
+   the top 5 bits, keep the values 8 apart */
+#define IRQ_PRIO_FIQ		0x00	/* Group 0 sources, signalled as FIQ */
+#define IRQ_PRIO_HPS_TIMER1	0x20	/* reserved for the RT release timer */
+#define IRQ_PRIO_HPS_TIMER0	0x40	/* kernel tick */
+#define IRQ_PRIO_A9_TIMER	0x60
+#define IRQ_PRIO_UART0		0xA0
+#define IRQ_PRIO_KERN_SGI	0xA0
+
+/* kernel ceiling for PMR critical sections: sources at this priority or
+   below are held off, more urgent ones still come in and must not touch
+   kernel state other than k_work_queue */
+#define KERN_IRQ_CEILING	IRQ_PRIO_HPS_TIMER0
+
+/* irq handler return values, tell the kernel what to do on the way out */
+#define IRQ_DONE		0		/* no task became READY */
+#define IRQ_PREEMPT		1		/* switch if a higher priority task is READY */
+#define IRQ_YIELD		2		/* rotate to the next READY task */
+
 #define __IM     volatile const      /* Defines 'read only' structure member permissions */
 #define __OM     volatile            /* Defines 'write only' structure member permissions */
 #define __IOM    volatile            /* Defines 'read/write' structure member permissions */
 
 typedef unsigned int uint32_t;
 
+typedef uint32_t (*IRQ_HANDLER)(uint32_t irq_id, void *arg);
+
 
 void GIC_Enable(void);
 void GIC_EnableIRQ(uint32_t);
@@ -72,6 +97,14 @@ void GIC_EnableDistributor(void);
 void GIC_CPUInterfaceInit(void);
 void GIC_DistInit(void);
 
+int irq_register(uint32_t irq_id, IRQ_HANDLER handler, void *arg);
+int fiq_register(uint32_t irq_id, IRQ_HANDLER handler, void *arg);
+uint32_t irq_dispatch(void);
+void fiq_dispatch(void);
+void irq_raise_sgi(uint32_t sgi_id);
+uint32_t irq_get_count(uint32_t irq_id);
+uint32_t irq_get_max_time(uint32_t irq_id);
+
 typedef struct
 {
     uint32_t CTLR;					/* Offset: 0x000 (R/W) Distributor Control Register */
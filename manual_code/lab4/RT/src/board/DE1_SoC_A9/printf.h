@@ -47,7 +47,8 @@ Two printf variants are provided: printf and sprintf.
 
 The formats supported by this implementation are: 'd' 'u' 'c' 's' 'x' 'X'.
 
-Zero padding and field width are also supported.
+Zero padding and field width are also supported, and %-Ns pads a
+string on the right.
 
 If the library is compiled with 'PRINTF_SUPPORT_LONG' defined then the 
 long specifier is also
@@ -110,6 +110,11 @@ Reset_Handler   PROC
                 IMPORT  main
                 IMPORT  g_k_stacks					; the kernel stack array symbol
                 IMPORT  g_k_stack_size              ; the kernel stack size for each task
+                IMPORT  ||Load$$OCRAM$$Base||       [WEAK]
+                IMPORT  ||Image$$OCRAM$$Base||      [WEAK]
+                IMPORT  ||Image$$OCRAM$$Length||    [WEAK]
+                IMPORT  ||Image$$OCRAM$$ZI$$Base||  [WEAK]
+                IMPORT  ||Image$$OCRAM$$ZI$$Length|| [WEAK]
                 LDR     R0, =g_k_stacks             ; R0 has the starting address of g_k_stacks[][] array
                 LDR     R1, =g_k_stack_size         ; R1 has the kernel stack size
                 LDR     R1, [R1]
@@ -132,6 +137,28 @@ goToSleep
                 MCR     p15, 0, R0, c1, c0, 0       ; Write value back to CP15 System Control register
                 ISB
 
+; Copy the OCRAM execution region down from its load address and zero its ZI
+; part, see scatter_DE1_SoC.sct. Without KERN_OCRAM the weak symbols are 0
+                LDR     R0, =||Load$$OCRAM$$Base||
+                LDR     R1, =||Image$$OCRAM$$Base||
+                LDR     R2, =||Image$$OCRAM$$Length||
+                ADD     R2, R2, #3
+                BIC     R2, R2, #3                  ; whole words
+copyOcram
+                SUBS    R2, R2, #4
+                LDRPL   R3, [R0], #4
+                STRPL   R3, [R1], #4
+                BHI     copyOcram
+                LDR     R1, =||Image$$OCRAM$$ZI$$Base||
+                LDR     R2, =||Image$$OCRAM$$ZI$$Length||
+                ADD     R2, R2, #3
+                BIC     R2, R2, #3
+                MOV     R3, #0
+zeroOcram
+                SUBS    R2, R2, #4
+                STRPL   R3, [R1], #4
+                BHI     zeroOcram
+
 ; Configure ACTLR
                 MRC     p15, 0, r0, c1, c0, 1       ; Read CP15 Auxiliary Control Register
                 ORR     r0, r0, #(1 <<  1)          ; Enable L2 prefetch hint (UNK/WI since r4p1)
@@ -25,6 +25,7 @@
  *****************************************************************************/
 
 #include "k_HAL_CA.h"
+#include "k_irq.h"
 #include "../DE1_SoC_A9/device_a9.h"
 #include "../DE1_SoC_A9/interrupt.h"
 #include "../DE1_SoC_A9/Serial.h"
@@ -54,10 +55,18 @@ void StackInit(void) {
 
 void SystemInit(void) {
 	GIC_Enable();
-	GIC_EnableIRQ(UART0_Rx_IRQ_ID);
-	GIC_EnableIRQ(HPS_TIMER0_IRQ_ID);
-	GIC_EnableIRQ(HPS_TIMER1_IRQ_ID);
-	GIC_EnableIRQ(A9_TIMER_IRQ_ID);
+	irq_register(UART0_Rx_IRQ_ID, k_irq_uart0, 0);
+	irq_register(HPS_TIMER0_IRQ_ID, k_irq_tick, 0);
+	irq_register(A9_TIMER_IRQ_ID, k_irq_timer, (void *) 2);
+	GIC_SetPriority(UART0_Rx_IRQ_ID, IRQ_PRIO_UART0);
+	GIC_SetPriority(HPS_TIMER0_IRQ_ID, IRQ_PRIO_HPS_TIMER0);
+	GIC_SetPriority(A9_TIMER_IRQ_ID, IRQ_PRIO_A9_TIMER);
+#ifdef RT_TIMER_FIQ
+	fiq_register(HPS_TIMER1_IRQ_ID, k_irq_timer, (void *) 1);
+#else
+	irq_register(HPS_TIMER1_IRQ_ID, k_irq_timer, (void *) 1);
+	GIC_SetPriority(HPS_TIMER1_IRQ_ID, IRQ_PRIO_HPS_TIMER1);
+#endif
 }
 /*
  *===========================================================================
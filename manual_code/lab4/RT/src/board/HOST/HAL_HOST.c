@@ -0,0 +1,249 @@
+/*
+ ****************************************************************************
+ *
+ *                  UNIVERSITY OF WATERLOO ECE 350 RTOS LAB
+ *
+ *              Copyright 2020-2021 Yiqing Huang and Zehan Gao
+ *                          All rights reserved.
+ *
+ *  Redistribution and use in source and binary forms, with or without
+ *  modification, are permitted provided that the following conditions are met:
+ *  - Redistributions of source code must retain the above copyright
+ *    notice and the following disclaimer.
+ *
+ *
+ *  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ *  AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ *  IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ *  ARE DISCLAIMED. IN NO EVENT SHALL COPYRIGHT HOLDERS AND CONTRIBUTORS BE
+ *  LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ *  CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ *  SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ *  INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ *  CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ *  ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ *  POSSIBILITY OF SUCH DAMAGE.
+ ****************************************************************************
+ */
+
+/**************************************************************************//**
+ * @file        HAL_HOST.c
+ * @brief       Hardware Abstraction Layer for the host port
+ * @version     V1.2021.01
+ * @authors     Yiqing Huang
+ * @date        2021 JAN
+ *
+ * @details     What HAL_CA.c does in assembly, in C on top of host_os.c:
+ *              - SVC: every system call of rtx_svc.h calls its entry of
+ *                g_svc_table with IRQs masked, then does the SVC_RESTORE
+ *                check of g_need_resched. host_svc does the same for a
+ *                bare SVC number, bounds check included
+ *              - IRQ: IRQ_Handler is entered from host_os.c with the I bit
+ *                clear, builds an IRQ_FRAME for c_IRQ_Handler and takes
+ *                the switch at the outermost exit
+ *              - k_tsk_switch: one host context per task. The msp of a
+ *                task that is switched out is its host stack pointer,
+ *                a task whose msp is anything else was just set up by
+ *                k_tsk_create_new and starts afresh in k_tsk_entry
+ *              - PMU: the cycle counter counts host nanoseconds, the
+ *                event counters read 0; no VFP switching is needed
+ *
+ *****************************************************************************/
+
+#include "k_inc.h"
+#include "k_HAL_CA.h"
+#include "k_task.h"
+#include "k_irq.h"
+#include "k_vfp.h"
+#include "rtx.h"
+
+/*
+ *===========================================================================
+ *                             MACROS
+ *===========================================================================
+ */
+
+/* the SVC stub of a system call: runs entry SVC_<name> of g_svc_table the
+   way SVC_Handler does, k_svc_exit runs once the return value is taken */
+#define RTX_SVC_LEAF(name, ret, params, args)                           \
+ret name params                                                         \
+{                                                                       \
+    U32 svc __attribute__((cleanup(k_svc_exit))) = k_svc_enter();       \
+    return ((ret (*) params) g_svc_table[SVC_##name]) args;            \
+}
+#define RTX_SVC(name, ret, params, args)                                \
+    RTX_SVC_LEAF(name, ret, params, args)
+
+/*
+ *===========================================================================
+ *                            GLOBAL VARIABLES
+ *===========================================================================
+ */
+
+U32 g_irq_nest;                 // interrupt nesting depth
+U32 SVC_RESTORE;                // k_tsk_create_new takes its address, never run
+
+static U32 *g_host_msp[HOST_NUM_CTX];   // msp of each task when it was switched out
+
+/*
+ *===========================================================================
+ *                            FUNCTIONS
+ *===========================================================================
+ */
+
+/**************************************************************************//**
+ * @brief   CPSR of the running task as far as the kernel can tell
+ * @note    the mode is the task's own, also inside an SVC stub
+ *****************************************************************************/
+uint32_t __get_CPSR(void)
+{
+    U32 mode = (gp_current_task == NULL || k_tcb_cold(gp_current_task)->priv) ? MODE_SVC : MODE_USR;
+
+    if (g_irq_nest != 0) {
+        mode = MODE_SVC;
+    }
+    return mode | (host_irq_masked() ? CPSR_I_BIT : 0);
+}
+
+static U32 k_svc_enter(void)
+{
+    return k_irq_lock();
+}
+
+static void k_svc_exit(U32 *p_state)
+{
+    if (g_need_resched != RESCHED_NONE) {
+        k_tsk_resched();        // a wakeup asked for a switch, take it on the way out
+    }
+    k_irq_unlock(*p_state);
+}
+
+/**************************************************************************//**
+ * @brief   an SVC by number, for callers with no stub to go through
+ * @return  what the call returns, RTX_ERR for a number past g_svc_table
+ * @note    does the bounds check SVC_Handler does before the table load
+ *****************************************************************************/
+int host_svc(unsigned int n)
+{
+    U32 svc __attribute__((cleanup(k_svc_exit))) = k_svc_enter();
+
+    if (n >= SVC_NUM) {
+        return RTX_ERR;
+    }
+    return ((int (*)(void)) g_svc_table[n])();
+}
+
+/**************************************************************************//**
+ * @brief   first run of a task, K_RESTORE into the fabricated frame
+ * @note    an unprivileged task leaves through SVC_RESTORE into USR mode
+ *          with IRQs on, a privileged one starts in SVC mode with IRQs
+ *          masked. A task that returns from its entry exits
+ *****************************************************************************/
+static void k_tsk_entry(void)
+{
+    if (k_tcb_cold(gp_current_task)->priv == 0) {
+        if (g_need_resched != RESCHED_NONE) {
+            k_tsk_resched();
+        }
+        __enable_irq();
+    }
+    k_tcb_cold(gp_current_task)->ptask();
+    tsk_exit();
+}
+
+/**************************************************************************//**
+ * @brief       switching kernel stacks of two TCBs
+ * @param:      p_tcb_old, the old tcb that was in RUNNING
+ * @pre:        gp_current_task is pointing to a valid TCB
+ *              gp_current_task->state = RUNNING
+ *              gp_crrent_task != p_tcb_old
+ *              p_tcb_old == NULL or p_tcb_old->state updated
+ * !!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!
+ * @attention   CRITICAL SECTION
+ * !!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!
+ *
+ *****************************************************************************/
+void k_tsk_switch(TCB *p_tcb_old)
+{
+    TCB *p_tcb_new = gp_current_task;
+    void (*entry)(void) = NULL;
+
+    if (p_tcb_new->msp != g_host_msp[p_tcb_new->tid]) {
+        entry = k_tsk_entry;
+    }
+    p_tcb_old->msp = (U32 *) __builtin_frame_address(0);
+    g_host_msp[p_tcb_old->tid] = p_tcb_old->msp;
+    __clrex();
+    host_ctx_switch(p_tcb_old->tid, p_tcb_new->tid, entry);
+}
+
+/**************************************************************************//**
+ * @brief   IRQ Handler, entered by host_os.c with the I bit clear
+ * @param   pc  host address the interrupted code was at
+ *****************************************************************************/
+void IRQ_Handler(unsigned int pc)
+{
+    U32 frame[IRQ_FRAME_SPSR + 1] = { 0 };
+
+    frame[IRQ_FRAME_PC] = pc;
+    frame[IRQ_FRAME_SPSR] = __get_CPSR();
+    __disable_irq();
+    g_irq_nest++;
+    c_IRQ_Handler(frame);               // dispatch, IRQs are masked again on return
+    if (--g_irq_nest == 0 && g_need_resched != RESCHED_NONE) {
+        k_tsk_resched();                // outermost: switch once
+    }
+    host_irq_return();
+}
+
+/**************************************************************************//**
+ * @brief   the cycle counter counts host nanoseconds, no event counters
+ *****************************************************************************/
+void k_pmu_init(void)
+{
+}
+
+void k_pmu_read(U32 *cnt)
+{
+    cnt[PMU_CYCLES] = (U32) host_clock_ns();
+    for (int i = 1; i < PMU_NUM_CNT; i++) {
+        cnt[i] = 0;
+    }
+}
+
+void k_cache_init(void)
+{
+}
+
+/**************************************************************************//**
+ * @brief   the host saves the whole register file on every switch
+ *****************************************************************************/
+void k_vfp_init(void)
+{
+}
+
+void k_vfp_reset(TCB *p_tcb)
+{
+}
+
+void k_vfp_switch(TCB *p_tcb)
+{
+}
+
+void k_vfp_claim(void)
+{
+}
+
+/*
+ *===========================================================================
+ *                          SVC STUBS, see rtx_svc.h
+ *===========================================================================
+ */
+
+#include "rtx_svc.h"
+
+/*
+ *===========================================================================
+ *                             END OF FILE
+ *===========================================================================
+ */
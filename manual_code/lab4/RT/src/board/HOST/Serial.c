@@ -0,0 +1,177 @@
+/*
+ ****************************************************************************
+ *
+ *                  UNIVERSITY OF WATERLOO ECE 350 RTOS LAB
+ *
+ *                     Copyright 2020-2021 Yiqing Huang
+ *                          All rights reserved.
+ *
+ *  Redistribution and use in source and binary forms, with or without
+ *  modification, are permitted provided that the following conditions are met:
+ *  - Redistributions of source code must retain the above copyright
+ *    notice and the following disclaimer.
+ *
+ *
+ *  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ *  AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ *  IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ *  ARE DISCLAIMED. IN NO EVENT SHALL COPYRIGHT HOLDERS AND CONTRIBUTORS BE
+ *  LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ *  CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ *  SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ *  INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ *  CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ *  ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ *  POSSIBILITY OF SUCH DAMAGE.
+ ****************************************************************************
+ */
+
+/**************************************************************************//**
+ * @file        Serial.c
+ * @brief       Host port serial driver
+ * @version     V1.2021.01
+ * @authors     Yiqing Huang
+ * @date        2021 JAN
+ *
+ * @note        The tx FIFO never fills, a character is out as soon as it
+ *              is written. The rx FIFO is one character deep: the tick
+ *              signal reads stdin into it when it is empty, the UART0
+ *              handler takes it out. As with the IIR, reading the irq
+ *              type clears a tx empty interrupt until the next write.
+ *
+ *****************************************************************************/
+
+#include "Serial.h"
+#include "interrupt.h"
+
+static int g_rx_irq;        /* rx data interrupt enabled              */
+static int g_tx_irq;        /* tx empty interrupt enabled             */
+static int g_tx_empty;      /* tx empty not yet reported              */
+static volatile int g_rx_char = -1;    /* rx FIFO, -1 if empty        */
+
+/*----------------------------------------------------------------------------
+  Write String to Serial Port
+ *----------------------------------------------------------------------------*/
+int SER_PutStr(int n, char *s)
+{
+  if (s == NULL)
+    return 1;
+  while (*s !=0) {      /* loop through each char in the string */
+    SER_PutChar(n, *s++);/* print the char, then ptr increments  */
+  }
+  return 0;
+}
+
+/*----------------------------------------------------------------------------
+  Write character to Serial Port
+ *----------------------------------------------------------------------------*/
+void SER_PutChar(int n, char c)
+{
+  host_putc(c);
+}
+
+/*----------------------------------------------------------------------------
+  Read character from Serial Port (blocking read)
+ *----------------------------------------------------------------------------*/
+char SER_GetChar(int n)
+{
+  int c = host_getc();
+
+  return (c < 0) ? '\0' : (char) c;
+}
+
+void UART0_Init(void)
+{
+  g_rx_irq = 1;
+  g_tx_irq = 0;
+}
+
+void UART0_PutChar(char c)
+{
+  host_putc(c);
+}
+
+char UART0_GetChar(void)
+{
+  return SER_GetChar(1);
+}
+
+void JTAG_UART_PutChar(char c)
+{
+  host_putc(c);
+}
+
+char JTAG_UART_GetChar(void)
+{
+  return SER_GetChar(0);
+}
+
+int UART0_GetRxIRQStatus(void)
+{
+  return g_rx_irq;
+}
+
+int UART0_GetRxDataStatus(void)
+{
+  return g_rx_char >= 0;
+}
+
+char UART0_GetRxData(void)
+{
+  char c = (char) g_rx_char;
+
+  g_rx_char = -1;
+  return c;
+}
+
+/* rx data ranks above tx empty, as in the IIR */
+int UART0_GetIRQType(void)
+{
+  if (g_rx_irq && UART0_GetRxDataStatus()) {
+    return UART0_IRQ_RX_DATA;
+  }
+  if (g_tx_irq && g_tx_empty) {
+    g_tx_empty = 0;
+    return UART0_IRQ_TX_EMPTY;
+  }
+  return UART0_IRQ_NONE;
+}
+
+void UART0_EnableTxIRQ(void)
+{
+  g_tx_irq = 1;
+  g_tx_empty = 1;
+  host_irq_kick();
+}
+
+void UART0_DisableTxIRQ(void)
+{
+  g_tx_irq = 0;
+}
+
+void UART0_PutTxData(char c)
+{
+  host_putc(c);
+  g_tx_empty = 1;           /* out at once, the FIFO is empty again */
+}
+
+int UART0_HostIRQ(void)
+{
+  return (g_rx_irq && g_rx_char >= 0) || (g_tx_irq && g_tx_empty);
+}
+
+/* called from the tick signal, the only writer of a full rx FIFO */
+void UART0_HostPoll(void)
+{
+  if (g_rx_char < 0) {
+    g_rx_char = host_getc_nb();
+  }
+}
+
+/*----------------------------------------------------------------------------
+  call back function for printf
+ *----------------------------------------------------------------------------*/
+void putc(void *p, char c)
+{
+  host_putc(c);
+}
@@ -0,0 +1,81 @@
+/*
+ ****************************************************************************
+ *
+ *                  UNIVERSITY OF WATERLOO ECE 350 RTOS LAB
+ *
+ *                     Copyright 2020-2021 Yiqing Huang
+ *                          All rights reserved.
+ *
+ *  Redistribution and use in source and binary forms, with or without
+ *  modification, are permitted provided that the following conditions are met:
+ *  - Redistributions of source code must retain the above copyright
+ *    notice and the following disclaimer.
+ *
+ *
+ *  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ *  AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ *  IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ *  ARE DISCLAIMED. IN NO EVENT SHALL COPYRIGHT HOLDERS AND CONTRIBUTORS BE
+ *  LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ *  CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ *  SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ *  INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ *  CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ *  ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ *  POSSIBILITY OF SUCH DAMAGE.
+ ****************************************************************************
+ */
+
+/**************************************************************************//**
+ * @file        Serial.h
+ * @brief       Host port serial driver header
+ * @version     V1.2021.01
+ * @authors     Yiqing Huang
+ * @date        2021 JAN
+ *
+ * @note        Same interface as the DE1 board. Both ports write to
+ *              stdout, UART0 receives from stdin.
+ *
+ *****************************************************************************/
+
+#ifndef SERIAL_H_
+#define SERIAL_H_
+
+#define UART0_TX_FIFO_SIZE              128       // tx FIFO depth in bytes
+
+/* UART0 interrupt types, IIR[3:0] */
+#define UART0_IRQ_NONE                  0x1       // no interrupt pending
+#define UART0_IRQ_TX_EMPTY              0x2       // transmit holding register empty
+#define UART0_IRQ_RX_DATA               0x4       // received data available
+
+/* ECE350 START */
+#define BIT(X)                          ( 1 << (X) )
+#define NULL                            0
+/* ECE350 END */
+
+extern char SER_GetChar (int n);
+extern void SER_PutChar(int n, char c);
+extern int  SER_PutStr(int n, char *s);
+
+void UART0_Init(void);
+void UART0_PutChar(char c);
+char UART0_GetChar (void);
+
+void JTAG_UART_PutChar(char c);
+char JTAG_UART_GetChar(void);
+
+extern int UART0_GetRxIRQStatus(void);
+extern int UART0_GetRxDataStatus(void);
+extern char UART0_GetRxData(void);
+extern int  UART0_GetIRQType(void);
+extern void UART0_EnableTxIRQ(void);
+extern void UART0_DisableTxIRQ(void);
+extern void UART0_PutTxData(char c);
+
+/* host only: interrupt line level and the rx poll on every kernel tick */
+extern int  UART0_HostIRQ(void);
+extern void UART0_HostPoll(void);
+
+extern void putc(void *p, char c);     /* call back function for printf */
+
+#endif /* SERIAL_H_ */
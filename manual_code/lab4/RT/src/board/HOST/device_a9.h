@@ -0,0 +1,44 @@
+/*
+ ****************************************************************************
+ *
+ *                  UNIVERSITY OF WATERLOO ECE 350 RTOS LAB
+ *
+ *                     Copyright 2020-2021 Yiqing Huang
+ *
+ *          This software is subject to an open source license and
+ *          may be freely redistributed under the terms of MIT License.
+ ****************************************************************************
+ */
+
+/**************************************************************************//**
+ * @file        device_a9.h
+ * @brief       Host port device specific header file
+ * @version     V1.2021.01
+ * @authors     Yiqing Huang
+ * @date        2021 JAN
+ *
+ * @note        The RAM is the HOST_RAM_SIZE array host_os.c places at
+ *              Image$$ZI_DATA$$ZI$$Limit, so k_mem_init works unchanged
+ *
+ *****************************************************************************/
+
+#ifndef DEVICE_A9_H_
+#define DEVICE_A9_H_
+
+/*
+ *===========================================================================
+ *                             MACROS
+ *===========================================================================
+ */
+
+#define NUM_PRIV_MODES  0x00000006      // 6 privileged modes
+#define STACK_SZ        0x00000200      // 512 B stack for each mode
+#define RAM_SIZE        HOST_RAM_SIZE
+#define RAM_END         ((unsigned int) (unsigned long) &Image$$ZI_DATA$$ZI$$Limit + RAM_SIZE - 1U)
+
+#endif
+/*
+ *===========================================================================
+ *                             END OF FILE
+ *===========================================================================
+ */
@@ -0,0 +1,334 @@
+/*
+ ****************************************************************************
+ *
+ *                  UNIVERSITY OF WATERLOO ECE 350 RTOS LAB
+ *
+ *                     Copyright 2020-2021 Yiqing Huang
+ *                          All rights reserved.
+ *
+ *  Redistribution and use in source and binary forms, with or without
+ *  modification, are permitted provided that the following conditions are met:
+ *  - Redistributions of source code must retain the above copyright
+ *    notice and the following disclaimer.
+ *
+ *
+ *  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ *  AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ *  IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ *  ARE DISCLAIMED. IN NO EVENT SHALL COPYRIGHT HOLDERS AND CONTRIBUTORS BE
+ *  LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ *  CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ *  SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ *  INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ *  CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ *  ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ *  POSSIBILITY OF SUCH DAMAGE.
+ ****************************************************************************
+ */
+
+/**************************************************************************//**
+ * @file        host_os.c
+ * @brief       Host port: Linux services behind host_port.h
+ *
+ * @version     V1.2021.01
+ * @authors     Yiqing Huang
+ * @date        2021 JAN
+ *
+ * @details     The only file of the host build that includes libc headers,
+ *              the rest of the tree keeps its own common.h types.
+ *              - reset: a constructor sets up the signals and runs
+ *                StackInit and SystemInit before main, as startup_a9.s does
+ *              - IRQ line: HPS timer n is a POSIX timer on SIGRTMIN + n.
+ *                Its handler marks the source pending in the emulated GIC
+ *                and, unless the I bit is set, enters IRQ_Handler right
+ *                there, so a task switch may happen inside the signal
+ *                handler. swapcontext saves and restores the signal mask
+ *                with the rest of the context, which keeps that sound.
+ *              - contexts: one ucontext per tid on a static host stack
+ *              - console: UART output goes to stdout, UART0 input comes
+ *                from stdin, polled on every kernel tick
+ *              - RTX_HOST_SEC=n in the environment ends the run after n
+ *                seconds, for scripted tests and benchmarks
+ *
+ *****************************************************************************/
+
+#define _GNU_SOURCE
+#include <errno.h>
+#include <poll.h>
+#include <signal.h>
+#include <stdarg.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <ucontext.h>
+#include <unistd.h>
+
+#define HOST_NUM_TIMERS     2       /* HPS timer 0 and 1 */
+
+/*
+ *===========================================================================
+ *                            GLOBAL VARIABLES
+ *===========================================================================
+ */
+
+/* the heap, k_mem_init takes everything from here to RAM_END */
+unsigned int Image$$ZI_DATA$$ZI$$Limit[HOST_RAM_SIZE >> 2] __attribute__((aligned(8)));
+
+volatile int g_host_excl;                   // exclusive monitor, see __ldrex
+
+static volatile sig_atomic_t g_host_irq_off = 1;   // emulated I bit, set out of reset
+static ucontext_t   g_host_ctx[HOST_NUM_CTX];
+static unsigned char g_host_stacks[HOST_NUM_CTX][HOST_STACK_SIZE] __attribute__((aligned(16)));
+static timer_t      g_host_timers[HOST_NUM_TIMERS];
+static int          g_host_rx_eof;          // stdin is closed, stop polling it
+
+/*
+ *===========================================================================
+ *                            FUNCTIONS
+ *===========================================================================
+ */
+
+/**************************************************************************//**
+ * @brief   take every pending interrupt the emulated GIC lets through
+ * @param   pc  where the interrupted code was, for the profiler
+ * @note    IRQ_Handler sets the I bit on entry and clears it with
+ *          host_irq_return, it may come back on another task's turn
+ *****************************************************************************/
+static void host_irq_take(unsigned long pc)
+{
+    while (!g_host_irq_off && irq_host_pending()) {
+        IRQ_Handler((unsigned int) pc);
+    }
+}
+
+int host_irq_disable(void)
+{
+    int masked = g_host_irq_off;
+
+    g_host_irq_off = 1;
+    __atomic_signal_fence(__ATOMIC_SEQ_CST);
+    return masked;
+}
+
+void host_irq_enable(void)
+{
+    __atomic_signal_fence(__ATOMIC_SEQ_CST);
+    g_host_irq_off = 0;
+    __atomic_signal_fence(__ATOMIC_SEQ_CST);
+    host_irq_take((unsigned long) __builtin_return_address(0));
+}
+
+int host_irq_masked(void)
+{
+    return g_host_irq_off;
+}
+
+/* a source went pending outside of a signal, e.g. an SGI or tx enable */
+void host_irq_kick(void)
+{
+    host_irq_take((unsigned long) __builtin_return_address(0));
+}
+
+/* exception return of IRQ_Handler, the interrupted code had IRQs on */
+void host_irq_return(void)
+{
+    __atomic_signal_fence(__ATOMIC_SEQ_CST);
+    g_host_irq_off = 0;
+}
+
+/* sleep until the next signal, the null task has nothing else to do */
+void host_wfi(void)
+{
+    pause();
+}
+
+static unsigned long host_sig_pc(void *uc)
+{
+#if defined(__x86_64__)
+    return (unsigned long) ((ucontext_t *) uc)->uc_mcontext.gregs[REG_RIP];
+#elif defined(__aarch64__)
+    return (unsigned long) ((ucontext_t *) uc)->uc_mcontext.pc;
+#else
+    return 0;
+#endif
+}
+
+static void host_sig_timer(int sig, siginfo_t *si, void *uc)
+{
+    int saved = errno;
+
+    timer_host_expire(sig - SIGRTMIN);
+    host_irq_take(host_sig_pc(uc));
+    errno = saved;
+}
+
+static void host_sig_stop(int sig)
+{
+    fflush(stdout);
+    _exit(0);
+}
+
+/**************************************************************************//**
+ * @brief   switch from one task context to another
+ * @param   old_id  tid of the running task, its context is saved
+ * @param   new_id  tid of the task to run
+ * @param   entry   non-NULL to start new_id afresh at entry
+ *****************************************************************************/
+void host_ctx_switch(int old_id, int new_id, void (*entry)(void))
+{
+    if (entry != NULL) {
+        ucontext_t *p_ctx = &g_host_ctx[new_id];
+
+        getcontext(p_ctx);
+        p_ctx->uc_stack.ss_sp = g_host_stacks[new_id];
+        p_ctx->uc_stack.ss_size = HOST_STACK_SIZE;
+        p_ctx->uc_link = NULL;
+        sigemptyset(&p_ctx->uc_sigmask);
+        makecontext(p_ctx, entry, 0);
+    }
+    swapcontext(&g_host_ctx[old_id], &g_host_ctx[new_id]);
+}
+
+unsigned long long host_clock_ns(void)
+{
+    struct timespec ts;
+
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (unsigned long long) ts.tv_sec * 1000000000ULL + ts.tv_nsec;
+}
+
+/**************************************************************************//**
+ * @brief   (re)start HPS timer n as a periodic host timer
+ * @param   period_ns   0 stops the timer
+ *****************************************************************************/
+void host_timer_start(int n, unsigned int period_ns)
+{
+    struct itimerspec its;
+
+    if (n < 0 || n >= HOST_NUM_TIMERS) {
+        return;
+    }
+    memset(&its, 0, sizeof(its));
+    its.it_value.tv_sec = period_ns / 1000000000U;
+    its.it_value.tv_nsec = period_ns % 1000000000U;
+    its.it_interval = its.it_value;
+    timer_settime(g_host_timers[n], 0, &its, NULL);
+}
+
+/* stdio is not re-entrant, a task switch must not land inside it */
+void host_putc(char c)
+{
+    int masked = host_irq_disable();
+
+    fputc(c, stdout);  /* putc is the printf callback in Serial.c */
+    if (c == '\n') {
+        fflush(stdout);
+    }
+    if (!masked) {
+        host_irq_enable();
+    }
+}
+
+/* blocking read of the console, -1 once stdin is closed */
+int host_getc(void)
+{
+    unsigned char c;
+
+    fflush(stdout);
+    while (read(STDIN_FILENO, &c, 1) != 1) {
+        if (errno != EINTR) {
+            g_host_rx_eof = 1;
+            return -1;
+        }
+    }
+    return c;
+}
+
+/* non-blocking read of the console, -1 if nothing is there */
+int host_getc_nb(void)
+{
+    unsigned char c;
+
+    if (!host_rx_ready()) {
+        return -1;
+    }
+    if (read(STDIN_FILENO, &c, 1) != 1) {
+        g_host_rx_eof = 1;
+        return -1;
+    }
+    return c;
+}
+
+int host_rx_ready(void)
+{
+    struct pollfd pfd = { STDIN_FILENO, POLLIN, 0 };
+
+    return !g_host_rx_eof && poll(&pfd, 1, 0) == 1 && (pfd.revents & (POLLIN | POLLHUP));
+}
+
+/* printf.h back end, masked like host_putc */
+void host_vprintf(const char *fmt, va_list va)
+{
+    int masked = host_irq_disable();
+
+    vprintf(fmt, va);
+    fflush(stdout);
+    if (!masked) {
+        host_irq_enable();
+    }
+}
+
+void host_vsprintf(char *s, const char *fmt, va_list va)
+{
+    vsprintf(s, fmt, va);
+}
+
+/**************************************************************************//**
+ * @brief   host counterpart of Reset_Handler, runs before main
+ *****************************************************************************/
+__attribute__((constructor))
+static void host_reset(void)
+{
+    struct sigaction sa;
+    const char *sec = getenv("RTX_HOST_SEC");
+
+    // kernel pointers are handed around as U32, build with -no-pie
+    if ((uintptr_t) &Image$$ZI_DATA$$ZI$$Limit[HOST_RAM_SIZE >> 2] > 0xFFFFFFFFUL ||
+        (uintptr_t) &g_host_stacks[HOST_NUM_CTX] > 0xFFFFFFFFUL) {
+        fprintf(stderr, "rtx host: image above 4 GB, link with -no-pie\n");
+        exit(1);
+    }
+    setvbuf(stdout, NULL, _IOFBF, 1 << 16);
+
+    memset(&sa, 0, sizeof(sa));
+    sa.sa_sigaction = host_sig_timer;
+    sa.sa_flags = SA_SIGINFO | SA_RESTART;
+    sigemptyset(&sa.sa_mask);
+    for (int n = 0; n < HOST_NUM_TIMERS; n++) {
+        sigaddset(&sa.sa_mask, SIGRTMIN + n);
+    }
+    for (int n = 0; n < HOST_NUM_TIMERS; n++) {
+        struct sigevent sev;
+
+        sigaction(SIGRTMIN + n, &sa, NULL);
+        memset(&sev, 0, sizeof(sev));
+        sev.sigev_notify = SIGEV_SIGNAL;
+        sev.sigev_signo = SIGRTMIN + n;
+        timer_create(CLOCK_MONOTONIC, &sev, &g_host_timers[n]);
+    }
+    if (sec != NULL) {
+        signal(SIGALRM, host_sig_stop);
+        alarm((unsigned int) atoi(sec));
+    }
+
+    StackInit();
+    SystemInit();
+}
+
+/*
+ *===========================================================================
+ *                             END OF FILE
+ *===========================================================================
+ */
@@ -0,0 +1,160 @@
+/*
+ ****************************************************************************
+ *
+ *                  UNIVERSITY OF WATERLOO ECE 350 RTOS LAB
+ *
+ *                     Copyright 2020-2021 Yiqing Huang
+ *                          All rights reserved.
+ *
+ *  Redistribution and use in source and binary forms, with or without
+ *  modification, are permitted provided that the following conditions are met:
+ *  - Redistributions of source code must retain the above copyright
+ *    notice and the following disclaimer.
+ *
+ *
+ *  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ *  AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ *  IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ *  ARE DISCLAIMED. IN NO EVENT SHALL COPYRIGHT HOLDERS AND CONTRIBUTORS BE
+ *  LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ *  CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ *  SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ *  INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ *  CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ *  ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ *  POSSIBILITY OF SUCH DAMAGE.
+ ****************************************************************************
+ */
+
+/**************************************************************************//**
+ * @file        host_port.h
+ * @brief       Host port: armcc intrinsics and the host OS services
+ *
+ * @version     V1.2021.01
+ * @authors     Yiqing Huang
+ * @date        2021 JAN
+ *
+ * @details     Force-included in front of every file of the host build
+ *              (gcc -include), it stands in for what armcc provides
+ *              built in. The IRQ mask is the emulated CPSR I bit: the
+ *              host signals behind the timers and the UART are never
+ *              blocked, a signal taken while the bit is set only leaves
+ *              the interrupt pending until __enable_irq.
+ *              Plain C types only, the file sits in front of common.h
+ *              in kernel files and of the libc headers in host_os.c.
+ *
+ *****************************************************************************/
+
+#ifndef HOST_PORT_H_
+#define HOST_PORT_H_
+
+/*
+ *===========================================================================
+ *                             MACROS
+ *===========================================================================
+ */
+
+#define HOST_NUM_CTX        256         /* one context per task_t value       */
+#define HOST_STACK_SIZE     0x10000     /* per task, libc calls need the room */
+#define HOST_RAM_SIZE       0x1000000   /* heap between the image and RAM_END */
+
+/* armcc keywords with nothing to do on the host */
+#define __irq
+#define __svc(n)
+#define __cpp(x)
+#define __int64             long long
+
+/*
+ *===========================================================================
+ *                            FUNCTION PROTOTYPES
+ *===========================================================================
+ */
+
+/* emulated CPSR I bit, see host_os.c */
+extern int  host_irq_disable    (void);
+extern void host_irq_enable     (void);
+extern int  host_irq_masked     (void);
+extern void host_irq_kick       (void);
+extern void host_irq_return     (void);
+extern void host_wfi            (void);
+
+/* task contexts, one per tid, run on host stacks */
+extern void host_ctx_switch     (int old_id, int new_id, void (*entry)(void));
+
+/* time, timers and the console */
+extern unsigned long long host_clock_ns (void);
+extern void host_timer_start    (int n, unsigned int period_ns);
+extern void host_putc           (char c);
+extern int  host_getc           (void);
+extern int  host_getc_nb        (void);
+extern int  host_rx_ready       (void);
+
+/* SVC #n without arguments, as SVC_Handler dispatches it, HAL_HOST.c */
+extern int  host_svc            (unsigned int n);
+
+/* provided by the board and the HAL for host_os.c to call back */
+extern void         IRQ_Handler         (unsigned int pc);
+extern unsigned int irq_host_pending    (void);
+extern void         timer_host_expire   (int n);
+extern void         StackInit           (void);
+extern void         SystemInit          (void);
+
+/*
+ *===========================================================================
+ *                             INTRINSICS
+ *===========================================================================
+ */
+
+#define __disable_irq()     host_irq_disable()
+#define __enable_irq()      host_irq_enable()
+#define __wfi()             host_wfi()
+#define __dsb(x)            __atomic_thread_fence(__ATOMIC_SEQ_CST)
+#define __isb(x)            __atomic_signal_fence(__ATOMIC_SEQ_CST)
+#define __current_sp()      ((unsigned int) (unsigned long) __builtin_frame_address(0))
+
+/* CLZ of 0 is 32 on ARM, undefined for __builtin_clz */
+static inline unsigned int __clz(unsigned int x)
+{
+    return (x == 0) ? 32U : (unsigned int) __builtin_clz(x);
+}
+
+/*
+ * Exclusive monitor: __ldrex opens it, any __strex closes it. A handler
+ * that runs in between and does its own LDREX/STREX leaves it closed, so
+ * the interrupted __strex fails as it would on the A9.
+ */
+extern volatile int g_host_excl;
+
+static inline unsigned int __ldrex(volatile unsigned int *p)
+{
+    g_host_excl = 1;
+    return *p;
+}
+
+static inline int __strex(unsigned int val, volatile unsigned int *p)
+{
+    int masked = host_irq_disable();
+    int rc = (g_host_excl == 0);
+
+    if (rc == 0) {
+        *p = val;
+    }
+    g_host_excl = 0;
+    if (!masked) {
+        host_irq_enable();
+    }
+    return rc;
+}
+
+static inline void __clrex(void)
+{
+    g_host_excl = 0;
+}
+
+#endif // ! HOST_PORT_H_
+
+/*
+ *===========================================================================
+ *                             END OF FILE
+ *===========================================================================
+ */
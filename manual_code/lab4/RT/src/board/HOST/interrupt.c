@@ -0,0 +1,281 @@
+/*
+ ****************************************************************************
+ *
+ *                  UNIVERSITY OF WATERLOO ECE 350 RTOS LAB
+ *
+ *                     Copyright 2020-2021 Zehan Gao
+ *                          All rights reserved.
+ *
+ *  Redistribution and use in source and binary forms, with or without
+ *  modification, are permitted provided that the following conditions are met:
+ *  - Redistributions of source code must retain the above copyright
+ *    notice and the following disclaimer.
+ *
+ *
+ *  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ *  AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ *  IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ *  ARE DISCLAIMED. IN NO EVENT SHALL COPYRIGHT HOLDERS AND CONTRIBUTORS BE
+ *  LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ *  CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ *  SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ *  INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ *  CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ *  ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ *  POSSIBILITY OF SUCH DAMAGE.
+ ****************************************************************************
+ */
+
+/**************************************************************************//**
+ * @file        interrupt.c
+ * @brief       Host port interrupt configuration and handler code
+ * @version     V1.2021.01
+ * @authors     Yiqing Huang
+ * @date        2021 JAN
+ *
+ * @note	Emulated GIC. Pending bits are set from signal handlers, so
+ *		they are only changed with atomic operations. Active sources
+ *		are kept on a stack of priorities, its top is the running
+ *		priority. UART0 is level triggered: it stays asserted while
+ *		UART0_HostIRQ says so.
+ *
+ *****************************************************************************/
+#include "interrupt.h"
+#include "Serial.h"
+#include "timer.h"
+#include "printf.h"
+#include "common.h"
+
+#define GIC_IDLE_PRIO	0x100	/* running priority with nothing active */
+#define GIC_MAX_ACTIVE	32		/* deepest nesting the stack can hold */
+
+typedef struct
+{
+	IRQ_HANDLER handler;			/* NULL if nothing is registered */
+	void *arg;						/* passed back to the handler */
+	uint32_t count;					/* number of times dispatched */
+	uint32_t max_time;				/* longest handler run in usec */
+	uint32_t prio;					/* GIC priority, lower is more urgent */
+	uint32_t enabled;				/* 1 if forwarded to the cpu */
+} IRQ_ENTRY;
+
+GICInterface_Type g_gic_cpu;
+
+static IRQ_ENTRY g_irq_table[GIC_NUM_IRQS];
+static volatile uint32_t g_irq_pend[GIC_NUM_IRQS / 32];
+static uint32_t g_irq_active[GIC_MAX_ACTIVE];	/* active ids, innermost last */
+static uint32_t g_irq_depth;
+static uint32_t g_irq_spurious;		/* acknowledges that returned no interrupt */
+
+// Running priority: that of the innermost active interrupt.
+static uint32_t gic_running_prio(void)
+{
+	return (g_irq_depth == 0) ? GIC_IDLE_PRIO : g_irq_table[g_irq_active[g_irq_depth - 1]].prio;
+}
+
+// Highest priority pending source the PMR and the running priority let
+// through, GIC_SPURIOUS_ID if there is none.
+static uint32_t gic_highest_pending(void)
+{
+	uint32_t best = GIC_SPURIOUS_ID;
+	uint32_t limit = gic_running_prio();
+
+	if (g_gic_cpu.PMR < limit)
+	{
+		limit = g_gic_cpu.PMR;
+	}
+	for (uint32_t w = 0; w < GIC_NUM_IRQS / 32U; w++)
+	{
+		uint32_t bits = g_irq_pend[w];
+
+		if (w == UART0_Rx_IRQ_ID / 32U && UART0_HostIRQ())
+		{
+			bits |= 1U << (UART0_Rx_IRQ_ID % 32U);
+		}
+		while (bits != 0)
+		{
+			uint32_t irq_id = w * 32U + (uint32_t) __builtin_ctz(bits);
+			IRQ_ENTRY *p_entry = &g_irq_table[irq_id];
+
+			bits &= bits - 1U;
+			if (p_entry->enabled && p_entry->prio < limit)
+			{
+				best = irq_id;
+				limit = p_entry->prio;
+			}
+		}
+	}
+	return best;
+}
+
+// Initialize and enable the GIC
+void GIC_Enable(void)
+{
+	for (uint32_t i = 0; i < GIC_NUM_IRQS; i++)
+	{
+		g_irq_table[i].prio = IRQ_PRIO_UART0;
+	}
+	g_gic_cpu.PMR = 0xFFU;
+	g_gic_cpu.CTLR = 1U;
+}
+
+// Sets the priority for the given interrupt.
+void GIC_SetPriority(uint32_t IRQn, uint32_t priority)
+{
+	g_irq_table[IRQn].prio = priority & 0xFFU;
+}
+
+// Read the current interrupt priority from GIC's IPRIORITYR register.
+uint32_t GIC_GetPriority(uint32_t IRQn)
+{
+	return g_irq_table[IRQn].prio;
+}
+
+// Set the interrupt priority mask using CPU's PMR register.
+void GIC_SetInterfacePriorityMask(uint32_t priority)
+{
+	g_gic_cpu.PMR = priority & 0xFFUL;
+}
+
+// Ends the innermost active interrupt.
+void GIC_EndInterrupt(uint32_t IRQn)
+{
+	if (g_irq_depth > 0)
+	{
+		g_irq_depth--;
+	}
+}
+
+// Enables the given interrupt.
+void GIC_EnableIRQ(uint32_t IRQn)
+{
+	g_irq_table[IRQn].enabled = 1;
+}
+
+// Disables the given interrupt.
+void GIC_DisableIRQ(uint32_t IRQn)
+{
+	g_irq_table[IRQn].enabled = 0;
+}
+
+// Acknowledge the highest priority pending interrupt, it becomes active.
+uint32_t GIC_AckPending(void)
+{
+	uint32_t irq_id = gic_highest_pending();
+
+	if (irq_id == GIC_SPURIOUS_ID || g_irq_depth == GIC_MAX_ACTIVE)
+	{
+		return GIC_SPURIOUS_ID;
+	}
+	__atomic_fetch_and(&g_irq_pend[irq_id / 32U], ~(1U << (irq_id % 32U)), __ATOMIC_SEQ_CST);
+	g_irq_active[g_irq_depth++] = irq_id;
+	return irq_id;
+}
+
+// Set a source pending, safe from a signal handler. The caller takes it
+// with host_irq_kick unless it is on its way into IRQ_Handler anyway.
+void irq_set_pending(uint32_t irq_id)
+{
+	__atomic_fetch_or(&g_irq_pend[irq_id / 32U], 1U << (irq_id % 32U), __ATOMIC_SEQ_CST);
+}
+
+// Install the handler of an interrupt source and enable it in the GIC.
+int irq_register(uint32_t irq_id, IRQ_HANDLER handler, void *arg)
+{
+	if (irq_id >= GIC_NUM_IRQS || handler == NULL)
+	{
+		return RTX_ERR;
+	}
+	g_irq_table[irq_id].handler = handler;
+	g_irq_table[irq_id].arg = arg;
+	GIC_EnableIRQ(irq_id);
+	return RTX_OK;
+}
+
+// No FIQ on the host: the source is an IRQ at the FIQ priority, above
+// every kernel ceiling.
+int fiq_register(uint32_t irq_id, IRQ_HANDLER handler, void *arg)
+{
+	if (irq_id >= GIC_NUM_IRQS || handler == NULL)
+	{
+		return RTX_ERR;
+	}
+	GIC_SetPriority(irq_id, IRQ_PRIO_FIQ);
+	return irq_register(irq_id, handler, arg);
+}
+
+// Acknowledge the pending interrupt, run its handler and end it.
+// Returns the handler's IRQ_DONE/IRQ_PREEMPT/IRQ_YIELD.
+// Called with IRQs masked, the handler runs with IRQs enabled unless
+// IRQ_NO_NESTING is defined; returns with IRQs masked.
+uint32_t irq_dispatch(void)
+{
+	uint32_t irq_id = GIC_AckPending() & 0x3FFU;
+	IRQ_ENTRY *p_entry;
+	uint32_t rc = IRQ_DONE;
+	uint32_t t0;
+	uint32_t dt;
+
+	if (irq_id >= GIC_NUM_IRQS)
+	{
+		g_irq_spurious++;
+		return IRQ_DONE;
+	}
+
+	p_entry = &g_irq_table[irq_id];
+	p_entry->count++;
+#ifndef IRQ_NO_NESTING
+	__enable_irq();
+#endif
+	t0 = timer_get_current_val(2);
+	if (p_entry->handler != NULL)
+	{
+		rc = p_entry->handler(irq_id, p_entry->arg);
+	}
+	else
+	{
+		printf("unrecognized interrupt %u!\r\n", irq_id);
+	}
+	__disable_irq();
+	dt = t0 - timer_get_current_val(2);	// the A9 timer counts down every usec
+	if (dt > p_entry->max_time)
+	{
+		p_entry->max_time = dt;
+	}
+	GIC_EndInterrupt(irq_id);
+	return rc;
+}
+
+// Number of times an interrupt was dispatched, GIC_SPURIOUS_ID for spurious ones.
+uint32_t irq_get_count(uint32_t irq_id)
+{
+	if (irq_id == GIC_SPURIOUS_ID)
+	{
+		return g_irq_spurious;
+	}
+	return (irq_id < GIC_NUM_IRQS) ? g_irq_table[irq_id].count : 0;
+}
+
+// Longest run of an interrupt handler in usec, nested handlers included.
+uint32_t irq_get_max_time(uint32_t irq_id)
+{
+	return (irq_id < GIC_NUM_IRQS) ? g_irq_table[irq_id].max_time : 0;
+}
+
+// Never entered on the host, see fiq_register.
+void fiq_dispatch(void)
+{
+}
+
+// Raise a software generated interrupt, taken right away unless masked.
+void irq_raise_sgi(uint32_t sgi_id)
+{
+	irq_set_pending(sgi_id & 0xFU);
+	host_irq_kick();
+}
+
+// Something a handler could take is pending, see host_irq_take.
+uint32_t irq_host_pending(void)
+{
+	return gic_highest_pending() != GIC_SPURIOUS_ID;
+}
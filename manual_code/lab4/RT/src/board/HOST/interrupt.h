@@ -0,0 +1,109 @@
+/*
+ ****************************************************************************
+ *
+ *                  UNIVERSITY OF WATERLOO ECE 350 RTOS LAB
+ *
+ *                     Copyright 2020-2021 Zehan Gao
+ *                          All rights reserved.
+ *
+ *  Redistribution and use in source and binary forms, with or without
+ *  modification, are permitted provided that the following conditions are met:
+ *  - Redistributions of source code must retain the above copyright
+ *    notice and the following disclaimer.
+ *
+ *
+ *  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ *  AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ *  IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ *  ARE DISCLAIMED. IN NO EVENT SHALL COPYRIGHT HOLDERS AND CONTRIBUTORS BE
+ *  LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ *  CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ *  SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ *  INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ *  CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ *  ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ *  POSSIBILITY OF SUCH DAMAGE.
+ ****************************************************************************
+ */
+
+/**************************************************************************//**
+ * @file        interrupt.h
+ * @brief       Host port interrupt configuration and handler header
+ * @version     V1.2021.01
+ * @authors     Yiqing Huang
+ * @date        2021 JAN
+ *
+ * @note	Same interface as the DE1 board. The GIC is emulated: sources
+ *		go pending from host signals or software, priorities, the
+ *		running priority and PMR behave as on the A9, there is no FIQ.
+ *
+ *****************************************************************************/
+
+#ifndef INTERRUPT_H
+#define	INTERRUPT_H
+
+#define	A9_TIMER_IRQ_ID 29
+#define	UART0_Rx_IRQ_ID 194
+#define	HPS_TIMER0_IRQ_ID 199
+#define	HPS_TIMER1_IRQ_ID 200
+
+#define GIC_NUM_IRQS	256		/* dispatch table size, covers every source used */
+#define GIC_SPURIOUS_ID	1023	/* IAR value when no interrupt is pending */
+#define KERN_SGI_ID		0		/* doorbell an FIQ handler rings to reach the kernel */
+
+/* GIC priorities, lower values preempt higher ones */
+#define IRQ_PRIO_FIQ		0x00	/* Group 0 sources, plain IRQs on the host */
+#define IRQ_PRIO_HPS_TIMER1	0x20	/* reserved for the RT release timer */
+#define IRQ_PRIO_HPS_TIMER0	0x40	/* kernel tick */
+#define IRQ_PRIO_A9_TIMER	0x60
+#define IRQ_PRIO_UART0		0xA0
+#define IRQ_PRIO_KERN_SGI	0xA0
+
+/* kernel ceiling for PMR critical sections */
+#define KERN_IRQ_CEILING	IRQ_PRIO_HPS_TIMER0
+
+/* irq handler return values, tell the kernel what to do on the way out */
+#define IRQ_DONE		0		/* no task became READY */
+#define IRQ_PREEMPT		1		/* switch if a higher priority task is READY */
+#define IRQ_YIELD		2		/* rotate to the next READY task */
+
+#define __IM     volatile const      /* Defines 'read only' structure member permissions */
+#define __OM     volatile            /* Defines 'write only' structure member permissions */
+#define __IOM    volatile            /* Defines 'read/write' structure member permissions */
+
+typedef unsigned int uint32_t;
+
+typedef uint32_t (*IRQ_HANDLER)(uint32_t irq_id, void *arg);
+
+
+void GIC_Enable(void);
+void GIC_EnableIRQ(uint32_t);
+void GIC_DisableIRQ(uint32_t);
+void GIC_EndInterrupt(uint32_t);
+uint32_t GIC_AckPending(void);
+void GIC_SetInterfacePriorityMask(uint32_t);
+uint32_t GIC_GetPriority(uint32_t);
+void GIC_SetPriority(uint32_t, uint32_t);
+
+int irq_register(uint32_t irq_id, IRQ_HANDLER handler, void *arg);
+int fiq_register(uint32_t irq_id, IRQ_HANDLER handler, void *arg);
+uint32_t irq_dispatch(void);
+void fiq_dispatch(void);
+void irq_raise_sgi(uint32_t sgi_id);
+void irq_set_pending(uint32_t irq_id);
+uint32_t irq_get_count(uint32_t irq_id);
+uint32_t irq_get_max_time(uint32_t irq_id);
+
+/* the CPU interface registers the kernel touches */
+typedef struct
+{
+  __IOM uint32_t CTLR;				/* CPU Interface Control Register */
+  __IOM uint32_t PMR;               /* Interrupt Priority Mask Register */
+  __IOM uint32_t BPR;               /* Binary Point Register */
+}  GICInterface_Type;
+
+extern GICInterface_Type g_gic_cpu;
+
+#define GICInterface	(&g_gic_cpu)
+
+#endif
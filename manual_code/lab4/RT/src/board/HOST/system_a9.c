@@ -0,0 +1,60 @@
+/*
+ ****************************************************************************
+ *
+ *                  UNIVERSITY OF WATERLOO ECE 350 RTOS LAB
+ *
+ *                     Copyright 2020-2021 Yiqing Huang
+ *
+ *          This software is subject to an open source license and
+ *          may be freely redistributed under the terms of MIT License.
+ ****************************************************************************
+ */
+
+/**************************************************************************//**
+ * @file        system_a9.c
+ * @brief       Host port System Initialization Source
+ *
+ * @version     V1.2021.01
+ * @authors     Yiqing Huang
+ * @date        2021 JAN
+ *
+ *****************************************************************************/
+
+#include "k_HAL_CA.h"
+#include "k_irq.h"
+#include "device_a9.h"
+#include "interrupt.h"
+#include "Serial.h"
+#include "timer.h"
+
+/**************************************************************************//**
+ * @brief		Nothing to do, there are no banked mode stacks on the host
+ * @see			host_os.c host_reset
+ *****************************************************************************/
+void StackInit(void) {
+}
+
+/**************************************************************************//**
+ * @brief		Setup the system, the same sources as on the DE1
+ *****************************************************************************/
+
+void SystemInit(void) {
+	GIC_Enable();
+	irq_register(UART0_Rx_IRQ_ID, k_irq_uart0, 0);
+	irq_register(HPS_TIMER0_IRQ_ID, k_irq_tick, 0);
+	irq_register(A9_TIMER_IRQ_ID, k_irq_timer, (void *) 2);
+	GIC_SetPriority(UART0_Rx_IRQ_ID, IRQ_PRIO_UART0);
+	GIC_SetPriority(HPS_TIMER0_IRQ_ID, IRQ_PRIO_HPS_TIMER0);
+	GIC_SetPriority(A9_TIMER_IRQ_ID, IRQ_PRIO_A9_TIMER);
+#ifdef RT_TIMER_FIQ
+	fiq_register(HPS_TIMER1_IRQ_ID, k_irq_timer, (void *) 1);
+#else
+	irq_register(HPS_TIMER1_IRQ_ID, k_irq_timer, (void *) 1);
+	GIC_SetPriority(HPS_TIMER1_IRQ_ID, IRQ_PRIO_HPS_TIMER1);
+#endif
+}
+/*
+ *===========================================================================
+ *                             END OF FILE
+ *===========================================================================
+ */
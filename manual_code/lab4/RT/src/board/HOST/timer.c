@@ -0,0 +1,157 @@
+/*
+ ****************************************************************************
+ *
+ *                  UNIVERSITY OF WATERLOO ECE 350 RTOS LAB
+ *
+ *                     Copyright 2020-2021 Zehan Gao
+ *                          All rights reserved.
+ *
+ *  Redistribution and use in source and binary forms, with or without
+ *  modification, are permitted provided that the following conditions are met:
+ *  - Redistributions of source code must retain the above copyright
+ *    notice and the following disclaimer.
+ *
+ *
+ *  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ *  AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ *  IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ *  ARE DISCLAIMED. IN NO EVENT SHALL COPYRIGHT HOLDERS AND CONTRIBUTORS BE
+ *  LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ *  CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ *  SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ *  INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ *  CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ *  ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ *  POSSIBILITY OF SUCH DAMAGE.
+ ****************************************************************************
+ */
+
+/**************************************************************************//**
+ * @file        timer.c
+ * @brief       Host port timer driver code
+ * @version     V1.2021.01
+ * @authors     Yiqing Huang
+ * @date        2021 JAN
+ *
+ * @note	Every timer counts down from its load value since it was
+ *		last enabled. Only the HPS timers interrupt, each through a
+ *		periodic host timer; the A9 timer is the free-running clock.
+ *
+ *****************************************************************************/
+#include "timer.h"
+#include "interrupt.h"
+#include "Serial.h"
+
+typedef struct {
+	unsigned int load;				/* count the timer reloads with */
+	unsigned int ns;				/* host nanoseconds per count */
+	unsigned int on;				/* enabled */
+	unsigned int irq;				/* interrupts unmasked */
+	unsigned long long t0;			/* host time it was enabled at */
+} HOST_TIMER;
+
+static HOST_TIMER g_timers[3] = {
+	{ 0, HPS_TIMER_NS, 0, 0, 0 },
+	{ 0, HPS_TIMER_NS, 0, 0, 0 },
+	{ 0, A9_TIMER_NS, 0, 0, 0 },
+};
+static const unsigned int g_timer_irq_id[2] = { HPS_TIMER0_IRQ_ID, HPS_TIMER1_IRQ_ID };
+
+void config_hps_timer(int n, int count, int mode, int irq_mask)
+{
+	if (n < 2)
+	{
+		timer_disable(n);
+		timer_set_count(n,count);
+		timer_set_mode(n,mode);
+		hps_timer_set_irq_mask(n,irq_mask);
+		timer_enable(n);
+	}
+}
+void config_a9_timer(int count, int mode, int irq_bit, unsigned char prescaler)
+{
+	timer_disable(2);
+	timer_set_count(2,count);
+	timer_set_mode(2,mode);
+	a9_timer_set_irq_bit(2, irq_bit);
+	a9_timer_set_prescaler(prescaler);
+	timer_enable(2);
+}
+void timer_disable(int n)
+{
+	if (n >= 0 && n <= 2)
+	{
+		g_timers[n].on = 0;
+		host_timer_start(n, 0);
+	}
+}
+void timer_enable(int n)
+{
+	if (n >= 0 && n <= 2)
+	{
+		HOST_TIMER *p_timer = &g_timers[n];
+
+		p_timer->on = 1;
+		p_timer->t0 = host_clock_ns();
+		if (n <= 1 && p_timer->irq)
+		{
+			host_timer_start(n, p_timer->load * p_timer->ns);
+		}
+	}
+}
+// all timers reload on the host, free-running and one-time included
+void timer_set_mode(int n, int mode)
+{
+}
+void timer_set_count(int n, int count)
+{
+	if (n >= 0 && n <= 2)
+	{
+		g_timers[n].load = (unsigned int) count;
+	}
+}
+void timer_clear_irq(int n)
+{
+}
+unsigned int timer_get_current_val(int n)
+{
+	HOST_TIMER *p_timer;
+	unsigned long long counts;
+
+	if (n < 0 || n > 2 || !g_timers[n].on || g_timers[n].load == 0)
+	{
+		return 0;
+	}
+	p_timer = &g_timers[n];
+	counts = (host_clock_ns() - p_timer->t0) / p_timer->ns;
+	if (n == 2)
+	{
+		return p_timer->load - (unsigned int) counts;	// wraps like the 32-bit counter
+	}
+	return p_timer->load - (unsigned int) (counts % p_timer->load);
+}
+void hps_timer_set_irq_mask(int n, int irq_mask)
+{
+	if (n >= 0 && n <= 1)
+	{
+		g_timers[n].irq = (irq_mask == 0);
+	}
+}
+void a9_timer_set_irq_bit(int n, int irq_bit)
+{
+}
+void a9_timer_set_prescaler(unsigned char prescaler)
+{
+	g_timers[2].ns = A9_TIMER_NS * (prescaler + 1U);
+}
+
+// The periodic host timer behind HPS timer n went off, from host_os.c.
+// The kernel tick also polls the console.
+void timer_host_expire(int n)
+{
+	if (n == 0)
+	{
+		UART0_HostPoll();
+	}
+	irq_set_pending(g_timer_irq_id[n]);
+}
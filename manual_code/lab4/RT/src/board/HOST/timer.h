@@ -0,0 +1,61 @@
+/*
+ ****************************************************************************
+ *
+ *                  UNIVERSITY OF WATERLOO ECE 350 RTOS LAB
+ *
+ *                     Copyright 2020-2021 Zehan Gao
+ *                          All rights reserved.
+ *
+ *  Redistribution and use in source and binary forms, with or without
+ *  modification, are permitted provided that the following conditions are met:
+ *  - Redistributions of source code must retain the above copyright
+ *    notice and the following disclaimer.
+ *
+ *
+ *  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ *  AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ *  IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ *  ARE DISCLAIMED. IN NO EVENT SHALL COPYRIGHT HOLDERS AND CONTRIBUTORS BE
+ *  LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ *  CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ *  SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ *  INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ *  CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ *  ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ *  POSSIBILITY OF SUCH DAMAGE.
+ ****************************************************************************
+ */
+
+/**************************************************************************//**
+ * @file        timer.h
+ * @brief       Host port timer driver header
+ * @version     V1.2021.01
+ * @authors     Yiqing Huang
+ * @date        2021 JAN
+ *
+ * @note	Same interface as the DE1 board, the counters are worked out
+ *		from the host monotonic clock
+ *
+ *****************************************************************************/
+#ifndef TIMER_H_
+#define TIMER_H_
+
+#define HPS_TIMER_NS	10		/* HPS timers count at 100 MHz */
+#define A9_TIMER_NS		5		/* A9 private timer counts at 200 MHz / (prescaler + 1) */
+
+void timer_disable(int n);                                  // disable timer, n = 0-1 for HPS, n = 2 for A9 private
+void timer_enable(int n);                                   // enable timer, n = 0-1 for HPS, n = 2 for A9 private
+void timer_set_mode(int n, int mode);                       // set mode, 1 for user-defined count or auto and 0 for free-running or one-time
+void timer_set_count(int n, int count);                     // set load count, only effective in user-defined count mode for n = 0-1
+void timer_clear_irq(int n);                                // clear timer's interrupt request
+unsigned int timer_get_current_val(int n);                  // get the current value of the timer's counter
+
+void hps_timer_set_irq_mask(int n, int irq_mask);           // set irq mask, 1 for no interrupts and 0 for interrupts
+void a9_timer_set_irq_bit(int n, int irq_bit);              // set irq bit, 0 for no interrupts and 1 for interrupts
+void a9_timer_set_prescaler(unsigned char prescaler);
+
+
+void config_hps_timer(int n, int count, int mode, int irq_mask);
+void config_a9_timer(int count, int mode, int irq_bit, unsigned char prescaler);
+
+#endif
@@ -1,8 +1,8 @@
  /**************************************************************************//**
  * @file     Serial.c
- * @brief    Simple polled UART driver
- * @version
- * @date     27 October 2015
+ * @brief    PL011 UART driver, same API as the DE1_SoC one
+ * @version  V1.2021.01
+ * @date     28 January 2021
  *
  * @note
  *
@@ -56,83 +56,92 @@
    ---------------------------------------------------------------------------*/
 
 #include "Serial.h"
+#include "interrupt.h"
 
+static volatile int g_tx_kick;  /* tx irq raised by UART0_EnableTxIRQ */
+
+/* make the UART0 interrupt pending in the GIC, for a tx kick */
+static void UART0_PendIRQ(void)
+{
+  GICDistributor->ISPENDR[UART0_Rx_IRQ_ID / 32U] = 1U << (UART0_Rx_IRQ_ID % 32U);
+}
 
 /*----------------------------------------------------------------------------
-  Enable Serial Port
+  Write String to Serial Port
  *----------------------------------------------------------------------------*/
-void SER_Enable(void)
+int SER_PutStr(int n, char *s)
 {
-    UART0->UARTCR = UART_CR_UARTEN | UART_CR_TXE | UART_CR_RXE;
+  if (s == NULL)
+    return 1;
+  while (*s !=0) {      /* loop through each char in the string */
+    SER_PutChar(n, *s++);/* print the char, then ptr increments  */
+  }
+  return 0;
 }
 
 /*----------------------------------------------------------------------------
-  Disable Serial Port
+  Write character to Serial Port
+  There is no JTAG UART on the VE, port 0 shares UART0 with port 1
  *----------------------------------------------------------------------------*/
-void SER_Disable(void)
+void SER_PutChar(int n, char c)
 {
-    UART0->UARTCR = 0x0;
+  UART0_PutChar(c);
 }
 
 /*----------------------------------------------------------------------------
-  Set baud rate
+  Read character from Serial Port (blocking read)
  *----------------------------------------------------------------------------*/
-void SER_Set_baud_rate(int n, uint32_t baud_rate)
+char SER_GetChar(int n)
 {
-    uint32_t divider;
-    uint32_t mod;
-    uint32_t fraction;
-
-    /*
-     * Set baud rate
-     *
-     * IBRD = UART_CLK / (16 * BAUD_RATE)
-     * FBRD = ROUND((64 * MOD(UART_CLK,(16 * BAUD_RATE))) / (16 * BAUD_RATE))
-     */
-    divider   = UART0_CLK / (16 * baud_rate);
-    mod       = UART0_CLK % (16 * baud_rate);
-    fraction  = (((8 * mod) / baud_rate) >> 1) + (((8 * mod) / baud_rate) & 1);
-
-    UART0->UARTIBRD = divider;
-    UART0->UARTFBRD = fraction;
+  return UART0_GetChar();
 }
 
-void SER_Init(int n)
+/*----------------------------------------------------------------------------
+  UART0 initialization
+ *----------------------------------------------------------------------------*/
+void UART0_Init(void)
 {
-    SER_Disable();  // Disable UART
-    SER_Set_baud_rate(n, 38400);
-    UART0->UARTLCR_H = UART_LCRH_WLEN_8 | UART_LCRH_FEN; // 8 bits, 1 stop bit, no parity, FIFO enabled
-    SER_Enable();   // Enable UART and enable TX/RX
+  UART0->UARTCR = 0x0;                              // disable while setting up
+  UART0_SetBaudRate(115200);                        // set baud rate to 115200
+  UART0->UARTLCR_H = UART_LCRH_WLEN_8 | UART_LCRH_FEN;  // 8 bits, FIFO enabled
+  UART0->UARTICR = 0x7FF;
+  UART0->UARTIMSC = UART_IMSC_RXIM | UART_IMSC_RTIM;    // enable rx interrupt
+  UART0->UARTCR = UART_CR_UARTEN | UART_CR_TXE | UART_CR_RXE;
 }
 
 /*----------------------------------------------------------------------------
-  Write character to Serial Port
+  Set baud rate
+  IBRD = UART_CLK / (16 * BAUD_RATE)
+  FBRD = ROUND((64 * MOD(UART_CLK,(16 * BAUD_RATE))) / (16 * BAUD_RATE))
  *----------------------------------------------------------------------------*/
-void SER_PutChar(int n, char c)
+void UART0_SetBaudRate(uint32_t baud_rate)
 {
-    while (UART0->UARTFR & 0x20);   // Wait for UART TX to become free
-    //if (c == '\n')
-    //{
-    //  UART0->UARTDR = '\r';
-    //  while (UART0->UARTFR & 0x20);
-    //}
-    UART0->UARTDR = c;
+  uint32_t divider  = UART0_CLK / (16 * baud_rate);
+  uint32_t mod      = UART0_CLK % (16 * baud_rate);
+  uint32_t fraction = (((8 * mod) / baud_rate) >> 1) + (((8 * mod) / baud_rate) & 1);
+
+  UART0->UARTIBRD = divider;
+  UART0->UARTFBRD = fraction;
 }
 
-/* HYQS */
+/*----------------------------------------------------------------------------
+  Write character to UART0
+ *----------------------------------------------------------------------------*/
+void UART0_PutChar(char c)
+{
+  while (UART0->UARTFR & UART_FR_TXFF);   // Wait for room in the tx FIFO
+  UART0->UARTDR = c;
+}
 
 /*----------------------------------------------------------------------------
-  Write String to Serial Port
+  Read character from UART0 (blocking read)
  *----------------------------------------------------------------------------*/
-int SER_PutStr(int n, char *s)
+char UART0_GetChar (void)
 {
-  if (s == NULL)
-	  return 1;
-  while (*s !=0) {      /* loop through each char in the string */
-	  SER_PutChar(0, *s++);/* print the char, then ptr increments  */
-  }
-  return 0;
+  while (UART0->UARTFR & UART_FR_RXFE);   // Wait for a character to arrive
+  return UART0->UARTDR;
 }
+
 /*----------------------------------------------------------------------------
  * Call back function for printf
  *----------------------------------------------------------------------------*/
@@ -146,32 +155,71 @@ void putc(void *p, char c)
   if ( p != NULL ) {
     SER_PutStr(0, "putc: first parameter needs to be NULL");
   } else {
-      SER_PutChar(0, c);
+    SER_PutChar(0, c);
   }
 }
 
-/* HYQE */
+int UART0_GetRxIRQStatus(void)
+{
+  return (UART0->UARTMIS & (UART_IMSC_RXIM | UART_IMSC_RTIM)) != 0;
+}
+
+int UART0_GetRxDataStatus(void)
+{
+  return (UART0->UARTFR & UART_FR_RXFE) == 0;
+}
+
+char UART0_GetRxData(void)
+{
+  return UART0->UARTDR & 0xFF;
+}
 
 /*----------------------------------------------------------------------------
-  Read character from Serial Port (blocking read)
+  Read the pending interrupt type in the DE1_SoC IIR encoding.
+  A tx interrupt is cleared here, as reading IIR does on the DE1_SoC
  *----------------------------------------------------------------------------*/
-char SER_GetChar (int n)
+int UART0_GetIRQType(void)
 {
-    while (UART0->UARTFR & 0x10);   // Wait for a character to arrive
-    return UART0->UARTDR;
+  uint32_t mis = UART0->UARTMIS;
+
+  if (mis & (UART_IMSC_RXIM | UART_IMSC_RTIM)) {
+    if (g_tx_kick) {
+      UART0_PendIRQ();          // the kick comes back once rx is drained
+    }
+    return UART0_IRQ_RX_DATA;
+  }
+  if (g_tx_kick || (mis & UART_IMSC_TXIM)) {
+    g_tx_kick = 0;
+    UART0->UARTICR = UART_IMSC_TXIM;
+    return UART0_IRQ_TX_EMPTY;
+  }
+  return 0;
 }
 
-int Interrupt_Rx(void)
+/*----------------------------------------------------------------------------
+  Enable/disable the tx FIFO drained interrupt.
+  The PL011 only raises it when the FIFO level drops through the trigger
+  level, so an already empty FIFO is signalled through the GIC instead
+ *----------------------------------------------------------------------------*/
+void UART0_EnableTxIRQ(void)
 {
-	return 0;
+  UART0->UARTIMSC |= UART_IMSC_TXIM;
+  if (UART0->UARTFR & UART_FR_TXFE) {
+    g_tx_kick = 1;
+    UART0_PendIRQ();
+  }
 }
 
-int Rx_Data_Ready(void)
+void UART0_DisableTxIRQ(void)
 {
-	return 0;
+  UART0->UARTIMSC &= ~UART_IMSC_TXIM;
+  g_tx_kick = 0;
 }
 
-char Rx_Read_Data(void)
+/*----------------------------------------------------------------------------
+  Write one character to the tx FIFO without waiting, caller tracks room
+ *----------------------------------------------------------------------------*/
+void UART0_PutTxData(char c)
 {
-	return 0;
+  UART0->UARTDR = c;
 }
@@ -1,8 +1,8 @@
  /**************************************************************************//**
  * @file     Serial.h
- * @brief    Simple polled UART driver. Needs to be completed 
- * @version
- * @date     07 February 2013
+ * @brief    PL011 UART driver, same API as the DE1_SoC one
+ * @version  V1.2021.01
+ * @date     28 January 2021
  *
  * @note
  *
@@ -140,28 +140,45 @@ typedef struct {
 #define UART_IMSC_CTSMIM          (1 << 1)
 #define UART_IMSC_RIMIM           (1 << 0)
 
-#define UART0_BASE      (0x1C090000u)  /* CS3 0x1C000000 + 0x090000 (VE ARM Cortex-A Series memory map) */
+#define UART0_BASE      (0x10009000u)  /* QEMU -M vexpress-a9, legacy CoreTile memory map */
 #define UART0           ((UART_Type *)UART0_BASE)
 
 #define UART0_CLK       24000000 // 24MHz
+#define UART0_TX_FIFO_SIZE  16   // tx FIFO depth in bytes
+
+/* Flag Register */
+#define UART_FR_TXFE              (1 << 7)
+#define UART_FR_TXFF              (1 << 5)
+#define UART_FR_RXFE              (1 << 4)
+
+/* UART0 interrupt types, the DE1_SoC IIR[3:0] codes */
+#define UART0_IRQ_TX_EMPTY  0x2  // transmit FIFO drained
+#define UART0_IRQ_RX_DATA   0x4  // received data available
 
 /* ECE350 START */
 #define BIT(X)                  ( 1 << (X) )
 #define NULL 0
 /* ECE350 END */
 
-/*TODO: add n to ser_xxx and also delete ser_enable and ser_disable*/
-extern void SER_Init(int n);
 extern char SER_GetChar (int n);
 extern void SER_PutChar(int n, char c);
 extern int  SER_PutStr(int n, char *s);
 
+void UART0_Init(void);
+void UART0_PutChar(char c);
+char UART0_GetChar (void);
+void UART0_SetBaudRate(uint32_t);
 
-extern int Interrupt_Rx(void);
-extern int Rx_Data_Ready(void);
-extern char Rx_Read_Data(void);
+extern int UART0_GetRxIRQStatus(void);
+extern int UART0_GetRxDataStatus(void);
+extern char UART0_GetRxData(void);
+extern int  UART0_GetIRQType(void);
+extern void UART0_EnableTxIRQ(void);
+extern void UART0_DisableTxIRQ(void);
+extern void UART0_PutTxData(char c);
 
 /* ECE350 START */
 extern void putc(void *p, char c);     /* call back function for printf, use uart */
 /* ECE350 END */
+
 #endif /* SERIAL_H_ */
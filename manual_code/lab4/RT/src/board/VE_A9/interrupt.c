@@ -33,17 +33,383 @@
  * @authors     Zehan Gao
  * @date        2021 FEB
  *
- * @note		Only a skeleton for VE_A9
- *
+ * @note	Same as the DE1_SoC one, the GIC of the A9 MPCore is the same
+ *		Reference to Intel University Program code
  *
  *****************************************************************************/
+#include "interrupt.h"
+#include "Serial.h"
+#include "timer.h"
+#include "printf.h"
+#include "common.h"
+
+typedef struct
+{
+	IRQ_HANDLER handler;			/* NULL if nothing is registered */
+	void *arg;						/* passed back to the handler */
+	uint32_t count;					/* number of times dispatched */
+	uint32_t max_time;				/* longest handler run in usec */
+	uint32_t fiq;					/* 1 if routed as FIQ through Group 0 */
+} IRQ_ENTRY;
+
+static IRQ_ENTRY g_irq_table[GIC_NUM_IRQS];
+static uint32_t g_irq_spurious;		/* acknowledges that returned no interrupt */
+static uint32_t g_fiq_on;			/* Group 1 set up for IRQs, Group 0 is FIQ */
+
+//Initialize and enable the GIC
+void GIC_Enable(void)
+{
+	GIC_DistInit();
+	GIC_CPUInterfaceInit(); //per CPU
+}
+
+// Interrupt distributor initialization
+void GIC_DistInit(void)
+{
+	uint32_t i;
+	uint32_t num_irq = 0U;
+	uint32_t priority_field;
+
+	//A reset sets all bits in the IGROUPRs corresponding to the SPIs to 0,
+	//configuring all of the interrupts as Secure.
+
+	//Disable interrupt forwarding
+	GIC_DisableDistributor();
+	//Get the maximum number of interrupts that the GIC supports
+	num_irq = 32U * ((GIC_DistributorInfo() & 0x1FU) + 1U);
+
+	/* Priority level is implementation defined.
+	 To determine the number of priority bits implemented write 0xFF to an IPRIORITYR
+	 priority field and read back the value stored.*/
+	GIC_SetPriority(0U, 0xFFU);
+	priority_field = GIC_GetPriority(0U);
+
+	for (i = 32U; i < num_irq; i++)
+	{
+		//Disable the SPI interrupt
+		GIC_DisableIRQ(i);
+		//Deactivate Interrupt
+		GIC_EndInterrupt(i);
+		//Set level-sensitive (and N-N model)
+		GIC_SetConfiguration(i, 0U);
+		//Set priority
+		GIC_SetPriority(i, priority_field / 2U);
+		//Set target list to CPU0
+		GIC_SetTarget(i, 1U);
+	}
+	//Enable distributor
+	GIC_EnableDistributor();
+}
+
+// CPU interrupt interface initialization
+void GIC_CPUInterfaceInit(void)
+{
+	uint32_t i;
+	uint32_t priority_field;
+
+	//A reset sets all bits in the IGROUPRs corresponding to the SPIs to 0,
+	//configuring all of the interrupts as Secure.
+
+	//Disable interrupt forwarding
+	GIC_DisableInterface();
+
+	/* Priority level is implementation defined.
+	 To determine the number of priority bits implemented write 0xFF to an IPRIORITYR
+	 priority field and read back the value stored.*/
+	GIC_SetPriority(0U, 0xFFU);
+	priority_field = GIC_GetPriority(0U);
+
+	//SGI and PPI
+	for (i = 0U; i < 32U; i++)
+	{
+		if (i > 15U)
+		{
+			//Set level-sensitive (and N-N model) for PPI
+			GIC_SetConfiguration(i, 0U);
+		}
+		//Disable SGI and PPI interrupts
+		GIC_DisableIRQ(i);
+		//Deactivate Interrupt
+		GIC_EndInterrupt(i);
+		//Set priority
+		GIC_SetPriority(i, priority_field / 2U);
+	}
+	//Enable interface
+	GIC_EnableInterface();
+	//Set binary point to 0
+	GIC_SetBinaryPoint(0U);
+	//Set priority mask
+	GIC_SetInterfacePriorityMask(0xFFU);
+}
+
+// Enable the interrupt distributor using the GIC's CTLR register
+void GIC_EnableDistributor(void)
+{
+	GICDistributor->CTLR |= 1U;
+}
+
+// Disable the interrupt distributor using the GIC's CTLR register.
+void GIC_DisableDistributor(void)
+{
+	GICDistributor->CTLR &= ~1U;
+}
+
+// Enable the CPU's interrupt interface
+void GIC_EnableInterface(void)
+{
+	GICInterface->CTLR = 1U;
+}
+
+// Disable the CPU's interrupt interface
+void GIC_DisableInterface(void)
+{
+	GICInterface->CTLR = 0x200;
+}
+
+// Read the GIC's TYPER register.
+uint32_t GIC_DistributorInfo(void)
+{
+	return (GICDistributor->TYPER);
+}
+
+// Set the priority for the given interrupt in the GIC's IPRIORITYR register.
+void GIC_SetPriority(uint32_t IRQn, uint32_t priority)
+{
+	uint32_t mask = GICDistributor->IPRIORITYR[IRQn / 4U]
+			& ~(0xFFUL << ((IRQn % 4U) * 8U));
+	GICDistributor->IPRIORITYR[IRQn / 4U] = mask
+			| ((priority & 0xFFUL) << ((IRQn % 4U) * 8U));
+}
+
+// Read the current interrupt priority from GIC's IPRIORITYR register.
+uint32_t GIC_GetPriority(uint32_t IRQn)
+{
+	return (GICDistributor->IPRIORITYR[IRQn / 4U] >> ((IRQn % 4U) * 8U))
+			& 0xFFUL;
+}
+
+// Disables the given interrupt using GIC's ICENABLER register.
+void GIC_DisableIRQ(uint32_t IRQn)
+{
+	GICDistributor->ICENABLER[IRQn / 32U] = 1U << (IRQn % 32U);
+}
 
-void interrupt_init(void)
+// Sets the interrupt configuration using GIC's ICFGR register.
+void GIC_SetConfiguration(uint32_t IRQn, uint32_t int_config)
 {
+	uint32_t icfgr = GICDistributor->ICFGR[IRQn / 16U];
+	uint32_t shift = (IRQn % 16U) << 1U;
 
+	icfgr &= (~(3U << shift));
+	icfgr |= (int_config << shift);
+
+	GICDistributor->ICFGR[IRQn / 16U] = icfgr;
+}
+
+// Sets the GIC's ITARGETSR register for the given interrupt.
+void GIC_SetTarget(uint32_t IRQn, uint32_t cpu_target)
+{
+	uint32_t mask = GICDistributor->ITARGETSR[IRQn / 4U]
+			& ~(0xFFUL << ((IRQn % 4U) * 8U));
+	GICDistributor->ITARGETSR[IRQn / 4U] = mask
+			| ((cpu_target & 0xFFUL) << ((IRQn % 4U) * 8U));
+}
+
+// Set the interrupt priority mask using CPU's PMR register.
+void GIC_SetInterfacePriorityMask(uint32_t priority)
+{
+	GICInterface->PMR = priority & 0xFFUL;
+}
+
+// Configures the group priority and subpriority split point using CPU's BPR register.
+void GIC_SetBinaryPoint(uint32_t binary_point)
+{
+	GICInterface->BPR = binary_point & 7U;
 }
 
-void disable_interrupt(void)
+// Writes the given interrupt number to the CPU's EOIR register.
+void GIC_EndInterrupt(uint32_t IRQn)
 {
+	GICInterface->EOIR = IRQn;
+}
+
+// Enables the given interrupt using GIC's ISENABLER register.
+void GIC_EnableIRQ(uint32_t IRQn)
+{
+	GICDistributor->ISENABLER[IRQn / 32U] = 1U << (IRQn % 32U);
+}
+
+// Read the CPU's IAR register.
+uint32_t GIC_AckPending(void)
+{
+	return (GICInterface->IAR);
+}
+
+// Install the handler of an interrupt source and enable it in the GIC.
+int irq_register(uint32_t irq_id, IRQ_HANDLER handler, void *arg)
+{
+	if (irq_id >= GIC_NUM_IRQS || handler == NULL)
+	{
+		return RTX_ERR;
+	}
+	g_irq_table[irq_id].handler = handler;
+	g_irq_table[irq_id].arg = arg;
+	GIC_EnableIRQ(irq_id);
+	return RTX_OK;
+}
+
+// The kernel doorbell has nothing to do itself: the work an FIQ handler
+// queued runs on the way out of the outermost IRQ.
+static uint32_t irq_doorbell(uint32_t irq_id, void *arg)
+{
+	return IRQ_DONE;
+}
 
+// Route an interrupt source as FIQ and install its handler.
+// The first call moves every other source to Group 1, still signalled as
+// IRQ, and enables FIQ signalling of Group 0 at the CPU interface.
+// An FIQ handler preempts kernel critical sections, so it must not touch
+// kernel state: it may only call k_work_queue, and returns IRQ_PREEMPT
+// to have the queued work run now rather than at the next interrupt.
+int fiq_register(uint32_t irq_id, IRQ_HANDLER handler, void *arg)
+{
+	uint32_t i;
+
+	if (irq_id >= GIC_NUM_IRQS || handler == NULL)
+	{
+		return RTX_ERR;
+	}
+	if (!g_fiq_on)
+	{
+		uint32_t num_irq = 32U * ((GIC_DistributorInfo() & 0x1FU) + 1U);
+
+		for (i = 0U; i < num_irq / 32U; i++)
+		{
+			GICDistributor->IGROUPR[i] = 0xFFFFFFFFU;
+		}
+		GICDistributor->CTLR |= 3U;		// forward both groups
+		// both groups, Secure IAR acks Group 1 too, Group 0 as FIQ, one BPR
+		GICInterface->CTLR = 0x1FU;
+		GIC_SetPriority(KERN_SGI_ID, IRQ_PRIO_KERN_SGI);
+		irq_register(KERN_SGI_ID, irq_doorbell, NULL);
+		g_fiq_on = 1;
+	}
+	GICDistributor->IGROUPR[irq_id / 32U] &= ~(1U << (irq_id % 32U));
+	GIC_SetPriority(irq_id, IRQ_PRIO_FIQ);
+	g_irq_table[irq_id].fiq = 1;
+	return irq_register(irq_id, handler, arg);
+}
+
+// Acknowledge the pending interrupt, run its handler and end it.
+// Returns the handler's IRQ_DONE/IRQ_PREEMPT/IRQ_YIELD.
+// Called with IRQs masked, the handler runs with IRQs enabled unless
+// IRQ_NO_NESTING is defined; returns with IRQs masked.
+uint32_t irq_dispatch(void)
+{
+	uint32_t irq_id = GIC_AckPending() & 0x3FFU;
+	IRQ_ENTRY *p_entry;
+	uint32_t rc = IRQ_DONE;
+	uint32_t t0;
+	uint32_t dt;
+
+	// IDs 1020-1023 are not interrupts and must not be ended
+	if (irq_id >= GIC_NUM_IRQS)
+	{
+		g_irq_spurious++;
+		return IRQ_DONE;
+	}
+
+	p_entry = &g_irq_table[irq_id];
+	p_entry->count++;
+#ifndef IRQ_NO_NESTING
+	// the GIC now masks everything up to this source's priority,
+	// let the more urgent ones in
+	__enable_irq();
+#endif
+	t0 = timer_get_current_val(2);
+	if (p_entry->handler != NULL)
+	{
+		rc = p_entry->handler(irq_id, p_entry->arg);
+	}
+	else
+	{
+		printf("unrecognized interrupt %u!\r\n", irq_id);
+	}
+	__disable_irq();
+	dt = t0 - timer_get_current_val(2);	// the A9 timer counts down every usec
+	if (dt > p_entry->max_time)
+	{
+		p_entry->max_time = dt;
+	}
+	GIC_EndInterrupt(irq_id);
+	return rc;
+}
+
+// Number of times an interrupt was dispatched, GIC_SPURIOUS_ID for spurious ones.
+uint32_t irq_get_count(uint32_t irq_id)
+{
+	if (irq_id == GIC_SPURIOUS_ID)
+	{
+		return g_irq_spurious;
+	}
+	return (irq_id < GIC_NUM_IRQS) ? g_irq_table[irq_id].count : 0;
+}
+
+// Longest run of an interrupt handler in usec, nested handlers included.
+uint32_t irq_get_max_time(uint32_t irq_id)
+{
+	return (irq_id < GIC_NUM_IRQS) ? g_irq_table[irq_id].max_time : 0;
+}
+
+// FIQ counterpart of irq_dispatch, runs in FIQ mode with IRQ and FIQ
+// masked. An IRQ source that won the acknowledge race is ended and made
+// pending again so that the IRQ path handles it.
+void fiq_dispatch(void)
+{
+	uint32_t irq_id = GIC_AckPending() & 0x3FFU;
+	IRQ_ENTRY *p_entry;
+	uint32_t rc;
+	uint32_t t0;
+	uint32_t dt;
+
+	if (irq_id >= GIC_NUM_IRQS)
+	{
+		g_irq_spurious++;
+		return;
+	}
+
+	p_entry = &g_irq_table[irq_id];
+	if (!p_entry->fiq)
+	{
+		GIC_EndInterrupt(irq_id);
+		if (irq_id < 16U)
+		{
+			irq_raise_sgi(irq_id);
+		}
+		else
+		{
+			GICDistributor->ISPENDR[irq_id / 32U] = 1U << (irq_id % 32U);
+		}
+		return;
+	}
+	p_entry->count++;
+	t0 = timer_get_current_val(2);
+	rc = p_entry->handler(irq_id, p_entry->arg);
+	dt = t0 - timer_get_current_val(2);
+	if (dt > p_entry->max_time)
+	{
+		p_entry->max_time = dt;
+	}
+	GIC_EndInterrupt(irq_id);
+	if (rc != IRQ_DONE)
+	{
+		irq_raise_sgi(KERN_SGI_ID);		// ring the kernel doorbell
+	}
+}
+
+// Raise a software generated interrupt on this CPU. SGIs are Group 1
+// once fiq_register has run and a Secure write must say so in NSATT.
+void irq_raise_sgi(uint32_t sgi_id)
+{
+	GICDistributor->SGIR = (2U << 24) | (g_fiq_on ? (1U << 15) : 0U) | (sgi_id & 0xFU);
 }
@@ -33,18 +33,143 @@
  * @authors     Zehan Gao, Intel University Program
  * @date        2021 FEB
  *
- * @note	Only support UART0_irq in current version
+ * @note	VE_A9 (QEMU vexpress-a9) copy of the DE1_SoC one, the A9 MPCore
+ *		GIC is the same, only the base addresses and IDs differ
  *
  *
  *****************************************************************************/
 
 #ifndef INTERRUPT_H
-#define INTERRUPT_H
+#define	INTERRUPT_H
 
-#define GIC_BASE 0x1e001000u
-#define UART_IRQ_ID 0
+/* QEMU -M vexpress-a9: SPI n of the motherboard is GIC ID 32 + n. The
+   SP804 timers at 0x10011000 and 0x10012000 stand in for HPS timer 0 and 1 */
+#define	A9_TIMER_IRQ_ID 29
+#define	UART0_Rx_IRQ_ID 37
+#define	HPS_TIMER0_IRQ_ID 34
+#define	HPS_TIMER1_IRQ_ID 35
+
+#define GIC_NUM_IRQS	256		/* dispatch table size, covers every source used */
+#define GIC_SPURIOUS_ID	1023	/* IAR value when no interrupt is pending */
+#define KERN_SGI_ID		0		/* doorbell an FIQ handler rings to reach the kernel */
+
+/* GIC priorities, lower values preempt higher ones. The A9 GIC implements
+   the top 5 bits, keep the values 8 apart */
+#define IRQ_PRIO_FIQ		0x00	/* Group 0 sources, signalled as FIQ */
+#define IRQ_PRIO_HPS_TIMER1	0x20	/* reserved for the RT release timer */
+#define IRQ_PRIO_HPS_TIMER0	0x40	/* kernel tick */
+#define IRQ_PRIO_A9_TIMER	0x60
+#define IRQ_PRIO_UART0		0xA0
+#define IRQ_PRIO_KERN_SGI	0xA0
+
+/* kernel ceiling for PMR critical sections: sources at this priority or
+   below are held off, more urgent ones still come in and must not touch
+   kernel state other than k_work_queue */
+#define KERN_IRQ_CEILING	IRQ_PRIO_HPS_TIMER0
+
+/* irq handler return values, tell the kernel what to do on the way out */
+#define IRQ_DONE		0		/* no task became READY */
+#define IRQ_PREEMPT		1		/* switch if a higher priority task is READY */
+#define IRQ_YIELD		2		/* rotate to the next READY task */
+
+#define __IM     volatile const      /* Defines 'read only' structure member permissions */
+#define __OM     volatile            /* Defines 'write only' structure member permissions */
+#define __IOM    volatile            /* Defines 'read/write' structure member permissions */
+
+typedef unsigned int uint32_t;
+
+typedef uint32_t (*IRQ_HANDLER)(uint32_t irq_id, void *arg);
 
-#endif
 
-void interrupt_init(void);
-void disable_interrupt(void);
+void GIC_Enable(void);
+void GIC_EnableIRQ(uint32_t);
+void GIC_DisableIRQ(uint32_t);
+void GIC_EndInterrupt(uint32_t);
+uint32_t GIC_AckPending(void);
+void GIC_SetBinaryPoint(uint32_t);
+void GIC_SetInterfacePriorityMask(uint32_t);
+void GIC_SetTarget(uint32_t, uint32_t);
+void GIC_SetConfiguration(uint32_t, uint32_t);
+uint32_t GIC_GetPriority(uint32_t);
+void GIC_SetPriority(uint32_t, uint32_t);
+uint32_t GIC_DistributorInfo(void);
+void GIC_DisableInterface(void);
+void GIC_EnableInterface(void);
+void GIC_DisableDistributor(void);
+void GIC_EnableDistributor(void);
+void GIC_CPUInterfaceInit(void);
+void GIC_DistInit(void);
+
+int irq_register(uint32_t irq_id, IRQ_HANDLER handler, void *arg);
+int fiq_register(uint32_t irq_id, IRQ_HANDLER handler, void *arg);
+uint32_t irq_dispatch(void);
+void fiq_dispatch(void);
+void irq_raise_sgi(uint32_t sgi_id);
+uint32_t irq_get_count(uint32_t irq_id);
+uint32_t irq_get_max_time(uint32_t irq_id);
+
+typedef struct
+{
+    uint32_t CTLR;					/* Offset: 0x000 (R/W) Distributor Control Register */
+    uint32_t TYPER;					/* Offset: 0x004 (R/ ) Interrupt Controller Type Register */
+    uint32_t IIDR;					/* Offset: 0x008 (R/ ) Distributor Implementer Identification Register */
+    uint32_t RESERVED0;
+    uint32_t STATUSR;				/* Offset: 0x010 (R/W) Error Reporting Status Register, optional */
+    uint32_t RESERVED1[11];
+    uint32_t SETSPI_NSR;			/* Offset: 0x040 ( /W) Set SPI Register */
+    uint32_t RESERVED2;
+    uint32_t CLRSPI_NSR;			/* Offset: 0x048 ( /W) Clear SPI Register */
+    uint32_t RESERVED3;
+    uint32_t SETSPI_SR;				/* Offset: 0x050 ( /W) Set SPI, Secure Register */
+    uint32_t RESERVED4;
+    uint32_t CLRSPI_SR;				/* Offset: 0x058 ( /W) Clear SPI, Secure Register */
+    uint32_t RESERVED5[9];
+    uint32_t IGROUPR[32];			/* Offset: 0x080 (R/W) Interrupt Group Registers */
+    uint32_t ISENABLER[32];			/* Offset: 0x100 (R/W) Interrupt Set-Enable Registers */
+    uint32_t ICENABLER[32];			/* Offset: 0x180 (R/W) Interrupt Clear-Enable Registers */
+    uint32_t ISPENDR[32];			/* Offset: 0x200 (R/W) Interrupt Set-Pending Registers */
+    uint32_t ICPENDR[32];			/* Offset: 0x280 (R/W) Interrupt Clear-Pending Registers */
+    uint32_t ISACTIVER[32];			/* Offset: 0x300 (R/W) Interrupt Set-Active Registers */
+    uint32_t ICACTIVER[32];			/* Offset: 0x380 (R/W) Interrupt Clear-Active Registers */
+    uint32_t IPRIORITYR[255];		/* Offset: 0x400 (R/W) Interrupt Priority Registers */
+    uint32_t RESERVED6;
+    uint32_t ITARGETSR[255];		/* Offset: 0x800 (R/W) Interrupt Targets Registers */
+    uint32_t RESERVED7;
+    uint32_t ICFGR[64];				/* Offset: 0xC00 (R/W) Interrupt Configuration Registers */
+    uint32_t IGRPMODR[32];			/* Offset: 0xD00 (R/W) Interrupt Group Modifier Registers */
+    uint32_t RESERVED8[32];
+    uint32_t NSACR[64];				/* Offset: 0xE00 (R/W) Non-secure Access Control Registers */
+    uint32_t SGIR;					/* Offset: 0xF00 ( /W) Software Generated Interrupt Register */
+    uint32_t RESERVED9[3];
+    uint32_t CPENDSGIR[4];			/* Offset: 0xF10 (R/W) SGI Clear-Pending Registers */
+    uint32_t SPENDSGIR[4];			/* Offset: 0xF20 (R/W) SGI Set-Pending Registers */
+}  GICDistributor_Type;
+
+typedef struct
+{
+  __IOM uint32_t CTLR;				/* Offset: 0x000 (R/W) CPU Interface Control Register */
+  __IOM uint32_t PMR;               /* Offset: 0x004 (R/W) Interrupt Priority Mask Register */
+  __IOM uint32_t BPR;               /* Offset: 0x008 (R/W) Binary Point Register */
+  __IM  uint32_t IAR;               /* Offset: 0x00C (R/ ) Interrupt Acknowledge Register */
+  __OM  uint32_t EOIR;              /* Offset: 0x010 ( /W) End Of Interrupt Register */
+  __IM  uint32_t RPR;               /* Offset: 0x014 (R/ ) Running Priority Register */
+  __IM  uint32_t HPPIR;             /* Offset: 0x018 (R/ ) Highest Priority Pending Interrupt Register */
+  __IOM uint32_t ABPR;              /* Offset: 0x01C (R/W) Aliased Binary Point Register */
+  __IM  uint32_t AIAR;              /* Offset: 0x020 (R/ ) Aliased Interrupt Acknowledge Register */
+  __OM  uint32_t AEOIR;             /* Offset: 0x024 ( /W) Aliased End Of Interrupt Register */
+  __IM  uint32_t AHPPIR;            /* Offset: 0x028 (R/ ) Aliased Highest Priority Pending Interrupt Register */
+  __IOM uint32_t STATUSR;           /* Offset: 0x02C (R/W) Error Reporting Status Register, optional */
+  uint32_t RESERVED1[40];
+  __IOM uint32_t APR[4];            /* Offset: 0x0D0 (R/W) Active Priority Register */
+  __IOM uint32_t NSAPR[4];          /* Offset: 0x0E0 (R/W) Non-secure Active Priority Register */
+  uint32_t RESERVED2[3];
+  __IM  uint32_t IIDR;              /* Offset: 0x0FC (R/ ) CPU Interface Identification Register */
+  uint32_t RESERVED3[960];
+  __OM  uint32_t DIR;               /* Offset: 0x1000( /W) Deactivate Interrupt Register */
+}  GICInterface_Type;
+
+
+#define GICDistributor	((GICDistributor_Type*)	0x1E001000)
+#define GICInterface	((GICInterface_Type*)	0x1E000100)
+
+#endif
@@ -145,11 +145,16 @@ void tfp_format(void* putp,putcf putf,char *fmt, va_list va)
 			putf(putp,ch);
 		else {
 			char lz=0;
+			char lj=0;
 #ifdef 	PRINTF_LONG_SUPPORT
 			char lng=0;
 #endif
 			int w=0;
 			ch=*(fmt++);
+			if (ch=='-') {	/* left justify, %s only */
+				ch=*(fmt++);
+				lj=1;
+				}
 			if (ch=='0') {
 				ch=*(fmt++);
 				lz=1;
@@ -198,9 +203,20 @@ void tfp_format(void* putp,putcf putf,char *fmt, va_list va)
 				case 'c' : 
 					putf(putp,(char)(va_arg(va, int)));
 					break;
-				case 's' : 
-					putchw(putp,putf,w,0,va_arg(va, char*));
+				case 's' : {
+					char* p=va_arg(va, char*);
+					if (lj) {
+						while (*p) {
+							putf(putp,*p++);
+							w--;
+							}
+						while (w-- > 0)
+							putf(putp,' ');
+						}
+					else
+						putchw(putp,putf,w,0,p);
 					break;
+					}
 				case '%' :
 					putf(putp,ch);
 				default:
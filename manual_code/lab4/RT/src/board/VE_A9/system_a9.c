@@ -24,32 +24,47 @@
  *
  *****************************************************************************/
 #include "system_a9.h"
+#include "k_irq.h"
+#include "interrupt.h"
+#include "Serial.h"
+#include "timer.h"
 
-// statically allocated initial stacks except for SVC mode and SYS mode
-U32 g_stacks[NUM_PRIV_MODES - 2][STACK_SZ >> 2];
+// statically allocated initial stacks except for SVC mode
+U32 g_stacks[NUM_PRIV_MODES - 1][STACK_SZ >> 2];
 
 /**************************************************************************//**
  * @brief		Set up stacks for each privileged mode except for SVC mode
- * @see			startup_a9.s Reset_Handler
+ * @see			startup_a9_gnu.S Reset_Handler
  *****************************************************************************/
 void StackInit(void) {
 	int i = 0;
-	__set_SP_MODE((U32) (g_stacks[++i]), MODE_IRQ);
-	__set_SP_MODE((U32) (g_stacks[++i]), MODE_FIQ);
-	__set_SP_MODE((U32) (g_stacks[++i]), MODE_ABT);
-	__set_SP_MODE((U32) (g_stacks[++i]), MODE_UND);
-	__set_SP_MODE((U32) (g_p_stacks[1]), MODE_SYS);
+	__set_SP_MODE((U32) (g_stacks[++i]), INIT_MODE_SYS);
+	__set_SP_MODE((U32) (g_stacks[++i]), INIT_MODE_IRQ);
+	__set_SP_MODE((U32) (g_stacks[++i]), INIT_MODE_FIQ);
+	__set_SP_MODE((U32) (g_stacks[++i]), INIT_MODE_ABT);
+	__set_SP_MODE((U32) (g_stacks[++i]), INIT_MODE_UND);
 }
 
 /**************************************************************************//**
- * @brief		Setup the system.
- *         		Initialize the System and update the SystemCoreClock variable.
- * @note		not needed for lab1 or lab2
+ * @brief		Setup the system, the same sources as on the DE1
+ * @note		QEMU's A9 MPCore GIC has no security extensions, so
+ *				RT_TIMER_FIQ gives an ordinary IRQ there
  *****************************************************************************/
 
 void SystemInit(void) {
-	// 1. copy vector table , not needed for VE9
-	// 2. TODO set up system clocks for devices, not needed for lab1 or lab2
+	GIC_Enable();
+	irq_register(UART0_Rx_IRQ_ID, k_irq_uart0, 0);
+	irq_register(HPS_TIMER0_IRQ_ID, k_irq_tick, 0);
+	irq_register(A9_TIMER_IRQ_ID, k_irq_timer, (void *) 2);
+	GIC_SetPriority(UART0_Rx_IRQ_ID, IRQ_PRIO_UART0);
+	GIC_SetPriority(HPS_TIMER0_IRQ_ID, IRQ_PRIO_HPS_TIMER0);
+	GIC_SetPriority(A9_TIMER_IRQ_ID, IRQ_PRIO_A9_TIMER);
+#ifdef RT_TIMER_FIQ
+	fiq_register(HPS_TIMER1_IRQ_ID, k_irq_timer, (void *) 1);
+#else
+	irq_register(HPS_TIMER1_IRQ_ID, k_irq_timer, (void *) 1);
+	GIC_SetPriority(HPS_TIMER1_IRQ_ID, IRQ_PRIO_HPS_TIMER1);
+#endif
 }
 /*
  *===========================================================================
@@ -43,8 +43,6 @@
 #include "k_HAL_CA.h"
 #include "common.h"
 
-extern U32 g_p_stacks[MAX_TASKS][PROC_STACK_SIZE >> 2] __attribute__((aligned(8)));
-
 /*
  *===========================================================================
  *                            FUNCTION PROTOTYPES
@@ -0,0 +1,164 @@
+/*
+ ****************************************************************************
+ *
+ *                  UNIVERSITY OF WATERLOO ECE 350 RTOS LAB
+ *
+ *                     Copyright 2020-2021 Zehan Gao
+ *                          All rights reserved.
+ *
+ *  Redistribution and use in source and binary forms, with or without
+ *  modification, are permitted provided that the following conditions are met:
+ *  - Redistributions of source code must retain the above copyright
+ *    notice and the following disclaimer.
+ *
+ *
+ *  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ *  AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ *  IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ *  ARE DISCLAIMED. IN NO EVENT SHALL COPYRIGHT HOLDERS AND CONTRIBUTORS BE
+ *  LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ *  CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ *  SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ *  INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ *  CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ *  ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ *  POSSIBILITY OF SUCH DAMAGE.
+ ****************************************************************************
+ */
+
+/**************************************************************************//**
+ * @file        timer.c
+ * @brief       Timer driver code
+ * @version     V1.2021.02
+ * @authors     Zehan Gao
+ * @date        2021 FEB
+ *
+ * @note	VE_A9 (QEMU vexpress-a9) version of the DE1_SoC driver
+ *
+ *****************************************************************************/
+#include "printf.h"
+#include "timer.h"
+#include "common.h"
+
+#define A9_CLK_RATIO    2           /* DE1 private timer clock / QEMU's, 200 / 100 MHz */
+
+timer_t* TIMERS[2] = {TIMER0, TIMER1};
+void config_hps_timer(int n, int count, int mode, int irq_mask)
+{
+	if (n < 2)
+	{
+		timer_disable(n);
+		timer_set_count(n,count);
+		timer_set_mode(n,mode);
+		hps_timer_set_irq_mask(n,irq_mask);
+		timer_enable(n);
+	}
+}
+void config_a9_timer(int count, int mode, int irq_bit, U8 prescaler)
+{
+	timer_disable(2);
+	timer_set_count(2,count);
+	timer_set_mode(2,mode);
+	a9_timer_set_irq_bit(2, irq_bit);
+	a9_timer_set_prescaler(prescaler);
+	timer_enable(2);
+}
+void timer_disable(int n)
+{
+	if(n >=0 && n <= 1)
+		TIMERS[n]->control &= ~SP804_CTRL_EN;
+	else if (n == 2)
+		ARMTIMER->controlreg &= ~(0x1);
+}
+void timer_enable(int n)
+{
+	if(n >=0 && n <= 1)
+		TIMERS[n]->control |= SP804_CTRL_EN | SP804_CTRL_32BIT;
+	else if(n == 2)
+		ARMTIMER->controlreg |= 0x1;
+}
+void timer_set_mode(int n, int mode)
+{
+	if(mode == 0)
+	{
+		if(n >= 0 && n <= 1)
+			//free-running, wraps around from 0 to 0xFFFFFFFF
+			TIMERS[n]->control &= ~SP804_CTRL_PERIODIC;
+		else if(n == 2)
+			//Set bit 1 of the control register to 0 to set the mode to one-time mode
+			ARMTIMER->controlreg &= ~(0x2);
+	}
+	else if(mode == 1)
+	{
+		if(n >= 0 && n <= 1)
+			//periodic, reloads the load count
+			TIMERS[n]->control |= SP804_CTRL_PERIODIC;
+		else if(n == 2)
+			//Set bit 1 of the control register to 1 to set the mode to auto mode
+			ARMTIMER->controlreg |= 0x2;
+	}
+}
+void timer_set_count(int n, int count)
+{
+	//Set the load count register to the given count
+	if(n >= 0 && n <= 1)
+	{
+		uint32_t load = (uint32_t) count / SP804_DIV;
+
+		TIMERS[n]->load = (load > 0) ? load : 1;
+	}
+	else if(n == 2)
+		ARMTIMER->loadcount = count;
+}
+void timer_clear_irq(int n)
+{
+	if(n >= 0 && n <= 1)
+		TIMERS[n]->intclr = 0x1;	//Any write clears the IRQ
+	else if(n == 2)
+		ARMTIMER->intstat = 0x1;  //Write to the interrupt status register to clear the IRQ
+}
+unsigned int timer_get_current_val(int n)
+{
+	// Return the current value of the counter in timer
+	if(n >= 0 && n <= 1)
+		return TIMERS[n]->value * SP804_DIV;
+	else if(n == 2)
+		return ARMTIMER->currentval;
+	return 0;
+}
+
+void hps_timer_set_irq_mask(int n, int irq_mask)
+{
+	if(n >= 0 && n <= 1)
+	{
+		if(irq_mask == 0)
+		{
+			TIMERS[n]->control |= SP804_CTRL_IE;
+		}
+		else if(irq_mask == 1)
+		{
+			TIMERS[n]->control &= ~SP804_CTRL_IE;
+		}
+	}
+}
+
+void a9_timer_set_irq_bit(int n, int irq_bit)
+{
+	if(n == 2)
+	{
+		if(irq_bit == 0)
+			ARMTIMER->controlreg &= ~(0x4);			//Set bit 2 of the control register to 0 to disable interrupt
+		else if(irq_bit == 1)
+			ARMTIMER->controlreg |= 0x4;            //Set bit 2 of the control register to 1 to enable interrupt
+	}
+}
+void a9_timer_set_prescaler(uint8_t prescaler)
+{
+	//prescaler is given for the DE1 clock, keep the same tick period
+	uint32_t div = (prescaler + 1U) / A9_CLK_RATIO;
+	volatile uint32_t controlreg = ARMTIMER->controlreg;
+
+	div = (div > 0) ? div - 1 : 0;
+	controlreg &= 0xF;
+	ARMTIMER->controlreg = (uint32_t) ((div << 8) + controlreg);
+}
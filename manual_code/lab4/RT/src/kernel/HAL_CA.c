@@ -42,10 +42,18 @@
 #include "k_inc.h"
 #include "k_HAL_CA.h"
 #include "interrupt.h"
-#include "Serial.h"
 #include "k_task.h"
-#include "timer.h"
-#include "printf.h"
+#include "k_irq.h"
+#include "k_vfp.h"
+#include "rtx.h"
+
+#define IRQ_STACK_SIZE  0x800   /* shared by all nested interrupt handlers */
+
+U32 g_irq_stack[IRQ_STACK_SIZE >> 2] K_HOT_DATA __attribute__((aligned(8)));
+U32 g_irq_nest K_HOT_DATA;      // interrupt nesting depth
+
+/* armcc embedded assembly, the GNU build assembles HAL_CA_gnu.S instead */
+#ifdef __CC_ARM
 
 #pragma push
 #pragma arm
@@ -70,35 +78,6 @@ T_Bit           EQU     0x20                ; when T bit is set, core is in Thum
 
 }
 
-/**************************************************************************//**
- * @brief   disable both IRQ and FIQ
- * @post    IRQ and FIQ disabled
- * TODO     needs more testing
- *****************************************************************************/
-__asm void __atomic_on(void)
-{
-        PRESERVE8
-        PUSH    {R4, LR}
-        MRS     R4, CPSR
-        ORR     R4, #I_Bit:OR:F_Bit ; set both I and F bits
-        MSR     CPSR_c, R4
-        POP     {R4, PC}
-}
-
-/**************************************************************************//**
- * @brief   enable both IRQ and FIQ
- * @post    IRQ and FIQ enabled
- * TODO     needs more testing
- *****************************************************************************/
-__asm void __atomic_off(void)
-{
-        PRESERVE8
-        PUSH    {R4, LR}
-        MRS     R4, CPSR
-        BIC     R4, #I_Bit:OR:F_Bit  ; clear both I and F bits
-        MSR     CPSR_c, R4
-        POP     {R4, PC}
-}
 #pragma pop
 
 /**************************************************************************//**
@@ -153,14 +132,62 @@ __asm void __set_SP_MODE (U32 sp, U32 mode) {
         POP     {R4, PC}
 }
 
+/*
+ * VFP/NEON access below uses the generic coprocessor forms (MCR/MRC p10,
+ * LDC/STC p11), the kernel is built for a cpu without VFP:
+ *   MCR p10, 7, Rt, c8, c0, 0      VMSR FPEXC, Rt
+ *   MRC p10, 7, Rt, c1, c0, 0      VMRS Rt, FPSCR
+ *   STC p11, c0, [Rn], #128        VSTMIA Rn!, {D0-D15}
+ *   STCL p11, c0, [Rn], #128       VSTMIA Rn!, {D16-D31}
+ */
+
+/**
+ * @brief       write FPEXC, FPEXC_EN switches the unit on
+ */
+__asm void __set_FPEXC (U32 fpexc) {
+        ARM
+        MCR     p10, 7, R0, c8, c0, 0
+        ISB
+        BX      LR
+}
+
+/**
+ * @brief       save D0-D31 and FPSCR to a VFP_CTX, the unit must be on
+ */
+__asm void __vfp_save (void *p_ctx) {
+        ARM
+        STC     p11, c0, [R0], #128
+        STCL    p11, c0, [R0], #128
+        MRC     p10, 7, R1, c1, c0, 0
+        STR     R1, [R0]
+        BX      LR
+}
+
+/**
+ * @brief       load D0-D31 and FPSCR from a VFP_CTX, the unit must be on
+ */
+__asm void __vfp_restore (void *p_ctx) {
+        ARM
+        LDC     p11, c0, [R0], #128
+        LDCL    p11, c0, [R0], #128
+        LDR     R1, [R0]
+        MCR     p10, 7, R1, c1, c0, 0
+        BX      LR
+}
+
 #pragma pop
 
 /**************************************************************************//**
  * @brief   	SVC Handler (i.e. trap handler)
  * @pre     	The caller should be in USR/SYS mode
- *          	R12 contains trap table mapped kernel function entry point
  *          	Processor is in ARM Mode
  * @attention   Only handles ARM Mode
+ * @details     SVC #n runs g_svc_table[n], n out of range fails with
+ *              RTX_ERR without a call. The leaf calls, n < SVC_NUM_LEAF,
+ *              never block and skip the exception frame: the caller
+ *              already gave up R0-R3 and R12, the C function keeps
+ *              R4-R11, so only LR_SVC needs saving. The frame is built
+ *              after the call in the rare case a wakeup asked for a switch
  *****************************************************************************/
 #pragma push
 #pragma arm
@@ -170,6 +197,28 @@ __asm void SVC_Handler (void)
         PRESERVE8                       ; 8 bytes alignement of the stack
         ARM
         EXPORT  SVC_RESTORE
+        IMPORT  k_tsk_resched
+
+        PUSH    {R4, LR}                ; R4 for the SVC number, SP stays 8B aligned
+        LDR     R4, [LR,#-4]            ; ARM:   Load Word
+        BIC     R4, R4, #0xFF000000     ; Extract SVC Number
+        CMP     R4, #__cpp(SVC_NUM_LEAF)
+        POPHS   {R4, LR}
+        BHS     SVC_SAVE
+
+        LDR     R12, =__cpp(&g_svc_table[0])
+        LDR     R12, [R12, R4, LSL #2]
+        BLX     R12                     ; leaf call, on the registers the caller passed
+
+        LDR     R4, =__cpp(&g_need_resched)
+        LDR     R4, [R4]
+        CMP     R4, #0
+        POP     {R4, LR}
+        MOVSEQ  PC, LR                  ; nothing pending: return, SPSR to CPSR
+        SRSFD   SP!, #Mode_SVC          ; a switch is due, the full frame after all
+        SUB     SP, SP, #56
+        STM     SP, {R0-R12, SP}^
+        B       SVC_RESTORE
 
 SVC_SAVE
 
@@ -178,19 +227,25 @@ SVC_SAVE
         STM     SP, {R0-R12, SP}^       ; push SP_USR and R0 - R12 onto the kernel stack
 
 
-        ;// extract SVC number, only handles #0
-        MRS     R4,SPSR                 ; Get SPSR
+        ;// extract SVC number, unknown ones fail with RTX_ERR
         LDR     R4,[LR,#-4]             ; ARM:   Load Word
         BIC     R4,R4,#0xFF000000       ; Extract SVC Number
+        CMP     R4, #__cpp(SVC_NUM)
+        MVNHS   R0, #0
+        BHS     SVC_RESTORE
 
-        CMP     R4,#0
-        BNE     SVC_EXIT                ; if not SVC #0, go to SVC_EXIT
-
+        LDR     R12, =__cpp(&g_svc_table[0])
+        LDR     R12, [R12, R4, LSL #2]
         BLX     R12                     ; invoke the corresponding c kernel function
 
 SVC_RESTORE
         STR     R0, [SP]                ; save the function return value on R0 that is on top of the stack
 
+        LDR     R4, =__cpp(&g_need_resched)
+        LDR     R4, [R4]
+        CMP     R4, #0
+        BLNE    k_tsk_resched           ; a wakeup asked for a switch, take it on the way out
+
 SVC_EXIT  
         LDM     SP, {R0-R12, SP}^       ; restore SP_USR and R0-R12 from their saved values on the stack
         ADD     SP, SP, #56
@@ -200,10 +255,53 @@ SVC_EXIT
 #pragma push
 #pragma arm
 
+/**************************************************************************//**
+ * @brief       switching kernel stacks of two TCBs
+ * @param:      p_tcb_old, the old tcb that was in RUNNING
+ * @return:     RTX_OK upon success
+ *              RTX_ERR upon failure
+ * @pre:        gp_current_task is pointing to a valid TCB
+ *              gp_current_task->state = RUNNING
+ *              gp_crrent_task != p_tcb_old
+ *              p_tcb_old == NULL or p_tcb_old->state updated
+ * @note:       caller must ensure the pre-conditions are met before calling.
+ *              the function does not check the pre-condition!
+ * !!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!
+ * @attention   CRITICAL SECTION
+ * !!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!
+ *
+ *****************************************************************************/
+__asm void k_tsk_switch(TCB *p_tcb_old)
+{
+        PUSH    {R0-R12, LR}
+        STR     SP, [R0, #__cpp(TCB_MSP_OFFSET)]   ; save SP to p_old_tcb->msp
+K_RESTORE
+        LDR     R1, =__cpp(&gp_current_task);
+        LDR     R2, [R1]
+        LDR     SP, [R2, #__cpp(TCB_MSP_OFFSET)]   ; restore msp of the gp_current_task
+
+        POP     {R0-R12, PC}
+}
+
+#pragma pop
+#pragma push
+#pragma arm
+
+/**************************************************************************//**
+ * @brief   	IRQ Handler, nests
+ * @details 	The interrupted context is saved on the current SVC stack:
+ *          	the task's kernel stack for the outermost interrupt, the
+ *          	interrupt stack for a nested one. Handlers then run on the
+ *          	interrupt stack with IRQs enabled, the GIC only lets through
+ *          	sources more urgent than its running priority. Context
+ *          	switches are left to the outermost exit, back on the task's
+ *          	kernel stack with IRQs masked.
+ *****************************************************************************/
 __asm void IRQ_Handler(void){
         PRESERVE8
         ARM
         IMPORT	c_IRQ_Handler
+        IMPORT	k_tsk_resched
 
         SUB     LR, LR, #4              ; Pre-adjust LR
         SRSFD   SP!, #Mode_SVC          ; Push LR_IRQ and SPSR_IRQ onto SVC mode stack
@@ -213,7 +311,31 @@ __asm void IRQ_Handler(void){
         SUB 	SP, SP, #8
         STM     SP, {SP}^		; Push SP_USR onto the kernel stack
 
-        BL 	c_IRQ_Handler           ; Call the uart interrupt handler for UART0 interrupt
+        LDR     R4, =__cpp(&g_irq_nest)
+        LDR     R5, [R4]
+        ADD     R5, R5, #1
+        STR     R5, [R4]                ; g_irq_nest++
+        MOV     R6, SP                  ; R6 = the saved frame
+        CMP     R5, #1
+        LDREQ   SP, =__cpp(&g_irq_stack[IRQ_STACK_SIZE >> 2])   ; outermost: move to the interrupt stack
+        BIC     SP, SP, #7              ; 8B align, a nested entry may come in on a 4B aligned SP
+        PUSH    {R5, R6}
+
+        MOV     R0, R6
+        BL 	c_IRQ_Handler           ; dispatch, IRQs are masked again on return
+
+        POP     {R5, R6}
+        MOV     SP, R6                  ; back onto the saved frame
+        LDR     R4, =__cpp(&g_irq_nest)
+        LDR     R5, [R4]
+        SUBS    R5, R5, #1
+        STR     R5, [R4]                ; g_irq_nest--
+        BNE     EXIT_IRQ                ; nested: back to the interrupted handler
+
+        LDR     R4, =__cpp(&g_need_resched)
+        LDR     R4, [R4]
+        CMP     R4, #0
+        BLNE    k_tsk_resched           ; outermost: switch once, on the task kernel stack
 
 EXIT_IRQ
         LDM     SP, {SP}^               ; Restore SP_USR and R0-R12 from their saved values on the stack
@@ -223,65 +345,126 @@ EXIT_IRQ
 }
 
 #pragma pop
+#pragma push
+#pragma arm
+
+/**************************************************************************//**
+ * @brief   	Undefined Instruction Handler, lazy VFP/NEON switching
+ * @details 	With the unit off, a task's first VFP/NEON instruction lands
+ *          	here: k_vfp_claim swaps the register banks and the
+ *          	instruction is run again. With the unit already on the
+ *          	instruction really is undefined, which hangs as before.
+ *****************************************************************************/
+__asm void Undef_Handler(void){
+        PRESERVE8
+        ARM
+        IMPORT  k_vfp_claim
+
+        PUSH    {R0-R3, R12, LR}
+        MRC     p10, 7, R0, c8, c0, 0   ; VMRS R0, FPEXC
+        TST     R0, #0x40000000         ; FPEXC_EN
+        BNE     UND_FAULT
+
+        BL      k_vfp_claim
+
+        MRS     R0, SPSR
+        LDR     R1, [SP, #20]           ; LR_und, past the trapped instruction
+        TST     R0, #T_Bit
+        SUBEQ   R1, R1, #4              ; ARM
+        SUBNE   R1, R1, #2              ; Thumb
+        STR     R1, [SP, #20]
+        POP     {R0-R3, R12, LR}
+        MOVS    PC, LR                  ; run it again, SPSR_und back into CPSR
+
+UND_FAULT
+        B       .
+}
+
+#pragma pop
+#pragma push
+#pragma arm
+
+/**************************************************************************//**
+ * @brief   	FIQ Handler
+ * @details 	Runs in FIQ mode on the FIQ stack, R8-R12 are banked so only
+ *          	the AAPCS scratch registers are saved. Never reschedules,
+ *          	see fiq_register for what an FIQ handler may do.
+ *****************************************************************************/
+__asm void FIQ_Handler(void){
+        PRESERVE8
+        ARM
+        IMPORT  fiq_dispatch
+
+        SUB     LR, LR, #4              ; Pre-adjust LR
+        PUSH    {R0-R3, R12, LR}        ; R12 only keeps the stack 8B aligned
+        BL      fiq_dispatch
+        LDM     SP!, {R0-R3, R12, PC}^  ; return, SPSR_fiq back into CPSR
+}
+
+#pragma pop
+
+#endif /* __CC_ARM */
 
 
-void c_IRQ_Handler(void)
+/**************************************************************************//**
+ * @brief   start the PMU cycle counter and the event counters behind
+ *          the per-task totals, all readable from USR mode
+ * @note    the cycle counter runs at the cpu clock, one count per cycle
+ *****************************************************************************/
+void k_pmu_init(void)
 {
-	static unsigned int a9_timer_last = 0xFFFFFFFF; // the initial value of free-running timer
-	unsigned int a9_timer_curr;
+	static const U32 events[PMU_NUM_CNT - 1] = {
+		PMU_EV_INST, PMU_EV_DCACHE_MISS, PMU_EV_BR_MISPRED
+	};
 
-	char switch_flag = 0;
-	// Read the ICCIAR from the CPU Interface in the GIC
-	U32 interrupt_ID = GIC_AckPending();
-	if (interrupt_ID == UART0_Rx_IRQ_ID)
-	{
-		if(UART0_GetRxIRQStatus())			// check if interrupt type is Data Receive
-		{
-			while(UART0_GetRxDataStatus())	// read while Data Ready is valid
-			{
-				char c = UART0_GetRxData();	// would also clear the interrupt if last character is read
-				SER_PutChar(1, c);	        // display back
-			}
-			switch_flag = 1;
-		}
-		else
-		{   // unexpected interrupt type
-			SER_PutStr(0, "Error interrupt type!\r\n");
-		}
-	}
-	else if(interrupt_ID == HPS_TIMER0_IRQ_ID)
-	{
-		timer_clear_irq(0);
-		a9_timer_curr = timer_get_current_val(2);	//get the current value of the free running timer
-		if ((a9_timer_last - a9_timer_curr) > 500000U)
-		{
-			printf("%d ms passed!\r\n", ((a9_timer_last - a9_timer_curr)/1000U));
-			a9_timer_last = a9_timer_curr;
-		}
-	}
-	else if(interrupt_ID == HPS_TIMER1_IRQ_ID)
-	{
-		timer_clear_irq(1);
-	}
-	else if(interrupt_ID == A9_TIMER_IRQ_ID)
-	{
-		timer_clear_irq(2);
-	}
-	else
+	for (int i = 0; i < PMU_NUM_CNT - 1; i++)
 	{
-		printf("unrecognized interrupt!\r\n");
+		CP15_WR(i, 0, c9, c12, 5);				// PMSELR
+		__isb(0xF);
+		CP15_WR(events[i], 0, c9, c13, 1);		// PMXEVTYPER
 	}
-	// Write to the End of Interrupt Register (ICCEOIR)
-	GIC_EndInterrupt(interrupt_ID);
-	// Make sure to call line 246 before context switching
-	if (switch_flag == 1)
+	CP15_WR(PMCR_E | PMCR_P | PMCR_C, 0, c9, c12, 0);	// PMCR
+	CP15_WR(PMCNTEN_CCNT | ((1U << (PMU_NUM_CNT - 1)) - 1), 0, c9, c12, 1);	// PMCNTENSET
+	CP15_WR(1, 0, c9, c14, 0);			// PMUSERENR, tasks read the counters directly
+}
+
+/**************************************************************************//**
+ * @brief   read the cycle counter and the event counters, PMU_* order
+ * @note    puts PMSELR back, a task may be halfway through its own read
+ *****************************************************************************/
+void k_pmu_read(U32 *cnt)
+{
+	U32 sel;
+
+	CP15_RD(sel, 0, c9, c12, 5);			// PMSELR
+	CP15_RD(cnt[PMU_CYCLES], 0, c9, c13, 0);	// PMCCNTR
+	for (int i = 1; i < PMU_NUM_CNT; i++)
 	{
-		k_tsk_run_new();
+		CP15_WR(i - 1, 0, c9, c12, 5);
+		__isb(0xF);
+		CP15_RD(cnt[i], 0, c9, c13, 2);			// PMXEVCNTR
 	}
+	CP15_WR(sel, 0, c9, c12, 5);
+	__isb(0xF);
 }
 
-/*
- *===========================================================================
- *                             END OF FILE
- *===========================================================================
- */
+/**************************************************************************//**
+ * @brief   with KERN_ICACHE, turn on the L1 instruction cache and branch
+ *          prediction that Reset_Handler leaves off
+ * @note    the MMU stays off, so data accesses are Strongly-ordered and
+ *          never cached; the D bit of SCTLR has no effect without it
+ *****************************************************************************/
+void k_cache_init(void)
+{
+#ifdef KERN_ICACHE
+	U32 sctlr;
+
+	CP15_WR(0, 0, c7, c5, 0);				// ICIALLU
+	CP15_WR(0, 0, c7, c5, 6);				// BPIALL
+	__dsb(0xF);
+	__isb(0xF);
+	CP15_RD(sctlr, 0, c1, c0, 0);			// SCTLR
+	CP15_WR(sctlr | SCTLR_I | SCTLR_Z, 0, c1, c0, 0);
+	__isb(0xF);
+#endif
+}
@@ -58,6 +58,7 @@
 #define K_HAL_CA_H_
 
 #include <stdint.h>
+#include "interrupt.h"
 
 /*
  *===========================================================================
@@ -87,6 +88,23 @@
 #define INIT_MODE_UND   0xDB
 #define INIT_MODE_SYS   0xDF
 
+ /* IRQ_Handler frame, word offsets from the saved SP_usr */
+#define IRQ_FRAME_PC    16          /* return address into the interrupted code */
+#define IRQ_FRAME_SPSR  17          /* its CPSR, mode in the low 5 bits     */
+
+#define PMCR_E          0x01        /* enable all PMU counters              */
+#define PMCR_P          0x02        /* reset the event counters             */
+#define PMCR_C          0x04        /* reset the cycle counter              */
+#define PMCNTEN_CCNT    0x80000000  /* PMCNTENSET bit of the cycle counter  */
+
+#define SCTLR_Z         0x00000800  /* branch prediction                    */
+#define SCTLR_I         0x00001000  /* L1 instruction cache                 */
+
+/* Cortex-A9 events on PMU event counters 0..2 */
+#define PMU_EV_INST         0x68    /* instructions out of the rename stage */
+#define PMU_EV_DCACHE_MISS  0x03    /* L1 data cache refill                 */
+#define PMU_EV_BR_MISPRED   0x10    /* branch mispredicted or not predicted */
+
 /*
  *===========================================================================
  *                             TYPEDEFS
@@ -104,19 +122,100 @@ typedef uint32_t        U32;
 /* START: ECE350 Functions */
 extern void __set_SP_MODE (U32 sp, U32 mode);
 extern void __ch_MODE (U32 mode);
-extern void __atomic_on(void);
-extern void __atomic_off(void);
-
+extern void k_pmu_init(void);
+extern void __set_FPEXC(U32 fpexc);
+extern void __vfp_save(void *p_ctx);
+extern void __vfp_restore(void *p_ctx);
+extern void k_pmu_read(U32 *cnt);
+extern void k_cache_init(void);
+
+extern U32 g_irq_nest;          /* interrupt nesting depth, kept by IRQ_Handler */
+
+#ifdef RTX_HOST
+extern uint32_t __get_CPSR(void);   /* emulated by the host port, board/HOST */
+#elif defined(__CC_ARM)
 static __inline uint32_t __get_CPSR(void) {
     register uint32_t __regCPSR __asm("cpsr");
     return (__regCPSR);
 }
+#else
+static __inline uint32_t __get_CPSR(void) {
+    uint32_t cpsr;
+    __asm volatile ("mrs %0, cpsr" : "=r" (cpsr));
+    return cpsr;
+}
+#endif
+
+/* CP15 access, e.g. CP15_RD(ccnt, 0, c9, c13, 0) is MRC p15, 0, ccnt, c9, c13, 0 */
+#ifdef __CC_ARM
+#define CP15_RD(v, op1, crn, crm, op2)  do {                            \
+        register U32 __cp15 __asm("cp15:" #op1 ":" #crn ":" #crm ":" #op2); \
+        (v) = __cp15;                                                   \
+    } while (0)
+#define CP15_WR(v, op1, crn, crm, op2)  do {                            \
+        register U32 __cp15 __asm("cp15:" #op1 ":" #crn ":" #crm ":" #op2); \
+        __cp15 = (v);                                                   \
+    } while (0)
+#else
+#define CP15_RD(v, op1, crn, crm, op2)  \
+    __asm volatile ("mrc p15, " #op1 ", %0, " #crn ", " #crm ", " #op2 : "=r" (v))
+#define CP15_WR(v, op1, crn, crm, op2)  \
+    __asm volatile ("mcr p15, " #op1 ", %0, " #crn ", " #crm ", " #op2 : : "r" (v) : "memory")
+#endif
 
 static __inline char __get_mode(void)
 {
     return (char)(__get_CPSR() & 0x1FU);
 }
 
+/*
+ * Critical sections. Both flavours nest: enter returns the previous state
+ * and exit puts it back, so an inner section never opens an outer one.
+ *
+ * k_irq_lock   CPSID i, holds off every IRQ
+ * k_pmr_raise  raises the GIC priority mask to KERN_IRQ_CEILING, sources
+ *              above the ceiling (and FIQs) still preempt. Interrupt
+ *              context only: in a task the outermost IRQ exit would run
+ *              deferred work and switch tasks inside the section
+ * k_crit_enter the flavour the kernel uses, PMR with KERN_CRIT_PMR
+ */
+static __inline U32 k_irq_lock(void)
+{
+    return (U32) __disable_irq();   // non-zero if IRQs were already masked
+}
+
+static __inline void k_irq_unlock(U32 state)
+{
+    if (state == 0) {
+        __enable_irq();
+    }
+}
+
+static __inline U32 k_pmr_raise(void)
+{
+    U32 pmr = GICInterface->PMR;
+
+    if (pmr > KERN_IRQ_CEILING) {
+        GICInterface->PMR = KERN_IRQ_CEILING;
+        __dsb(0xF);                 // mask in effect before the section starts
+        __isb(0xF);
+    }
+    return pmr;
+}
+
+static __inline void k_pmr_restore(U32 pmr)
+{
+    GICInterface->PMR = pmr;
+}
+
+#ifdef KERN_CRIT_PMR
+#define k_crit_enter()      k_pmr_raise()
+#define k_crit_exit(state)  k_pmr_restore(state)
+#else
+#define k_crit_enter()      k_irq_lock()
+#define k_crit_exit(state)  k_irq_unlock(state)
+#endif
+
 /* END: ECE350 Functions */
 
 #endif // ! K_HAL_CA_H_
@@ -43,6 +43,7 @@
 
 #include "device_a9.h"
 #include "common.h"
+#include "common_ext.h"
 
 /*
  *===========================================================================
@@ -50,7 +51,55 @@
  *===========================================================================
  */
 
-#define TCB_MSP_OFFSET  4
+#define NUM_PRIO_LEVELS 6           /* PRIO_RT, HIGH..LOWEST, PRIO_NULL       */
+#define KERN_TICK_USEC  MIN_RTX_QTM /* HPS timer 0 period, timeout resolution */
+#define KERN_TICK_COUNT (KERN_TICK_USEC * 100)  /* HPS timer 0 load, 100 MHz clock */
+#ifndef KERN_SLICE_TICKS
+#define KERN_SLICE_TICKS 100        /* round-robin slice among equal priorities, 10 ms */
+#endif
+#define RT_TIMER_COUNT  100000      /* HPS timer 1 load, 1 ms jitter probe    */
+
+/* per-task PMU totals, TCB pmu[] index */
+#define PMU_CYCLES      0
+#define PMU_INSTS       1
+#define PMU_DC_MISS     2
+#define PMU_BR_MISS     3
+#define PMU_NUM_CNT     4           /* cycle counter + 3 event counters       */
+
+/* g_need_resched values, stronger requests are larger */
+#define RESCHED_NONE    0           /* keep running the current task          */
+#define RESCHED_PREEMPT 1           /* switch if a higher priority task is READY */
+#define RESCHED_YIELD   2           /* rotate to the next READY task          */
+
+/* stack painting: the low STACK_PAINT_MAX bytes of every task stack are
+   filled with STACK_PAINT at creation, k_tsk_stack_used finds the deepest
+   word overwritten. Bounds the cost of a create, 0 turns painting off */
+#ifndef STACK_PAINT_MAX
+#define STACK_PAINT_MAX 0x200
+#endif
+#define STACK_PAINT     0x5A5A5A5A
+
+/* KERN_SRP: RT tasks share one user stack of SRP_STACK_SIZE bytes, each
+   job starts on it afresh and no other RT job starts until it is done.
+   One preemption level only, so a job may not block: recv_msg, send_msg_timed
+   and tsk_suspend fail at once on the shared stack */
+#ifndef SRP_STACK_SIZE
+#define SRP_STACK_SIZE  0x1000
+#endif
+
+/* user stacks are allocated from the heap, PROC_STACK_SIZE at least and
+   U_STACK_MAX at most, the largest multiple of 8 a U16 size holds */
+#define U_STACK_MAX     0xFFF8
+
+/* KERN_OCRAM: code and data on the switch and interrupt paths run from the
+   DE1-SoC on-chip RAM, see the OCRAM region of scatter_DE1_SoC.sct */
+#ifdef KERN_OCRAM
+#define K_HOT           __attribute__((section(".ocram_code")))
+#define K_HOT_DATA      __attribute__((section(".ocram_data")))
+#else
+#define K_HOT
+#define K_HOT_DATA
+#endif
 
 /*
  *===========================================================================
@@ -59,18 +108,83 @@
  */
 
 /**
- * @brief TCB data structure definition to support two kernel tasks.
- * @note  You will need to add more fields to this structure.
+ * @brief TCB, the fields the scheduler, the switch and the wait queues touch
+ * @note  fits one 32B A9 cache line, one line per TCB in g_tcbs[].
+ *        The rest of a task's state is its TCB_COLD, see k_tcb_cold()
  */
-typedef struct tcb {
-    struct tcb *next;   /**> next tcb, not used in this example         */
-    U32        *msp;    /**> msp of the task, TCB_MSP_OFFSET = 4        */
+typedef struct __attribute__((aligned(32))) tcb {
+    struct tcb *next;   /**> next tcb in the ready or wait queue        */
+    U32        *msp;    /**> msp of the task, TCB_MSP_OFFSET            */
     U8          tid;    /**> task id                                    */
     U8          prio;   /**> Execution priority                         */
     U8          state;  /**> task state                                 */
-    U8          priv;   /**> = 0 unprivileged, =1 privileged            */
+    U8          timed;  /**> = 1 while in the timer queue               */
+    struct tcb **wait_q;    /**> queue the task is blocked on, or NULL  */
+    int         wait_rc;    /**> RTX_OK if woken up, RTX_ERR on timeout */
+    struct tcb *tnext;      /**> next tcb in the timer queue            */
+    U32         tdelta;     /**> ticks after the previous timer entry   */
 } TCB;
 
+/* offset of msp for k_tsk_switch, HAL_CA.c and k_asm_offsets.c */
+#define TCB_MSP_OFFSET  ((U32) &((TCB *) 0)->msp)
+
+/**
+ * @brief task state off the scheduling path, g_tcb_cold[tid]
+ */
+typedef struct tcb_cold {
+    U32         run_time;   /**> accumulated run time in usec           */
+    U64         pmu[PMU_NUM_CNT];   /**> accumulated PMU counts, PMU_*      */
+    void      (*ptask)();   /**> task entry address                     */
+    U32         k_stack_hi; /**> kernel stack base (high addr.)         */
+    U32         u_stack_hi; /**> user stack base (high addr.)           */
+    U16         k_stack_size;   /**> kernel stack size in bytes         */
+    U16         u_stack_size;   /**> user stack size in bytes           */
+    U16         k_stack_used;   /**> kernel stack high-water, cached    */
+    U16         u_stack_used;   /**> user stack high-water, cached      */
+    U8          stk_gen;    /**> bumped at create/exit, see k_tsk_scan_idle */
+    U8          priv;       /**> = 0 unprivileged, =1 privileged        */
+    U8          rt_idle;    /**> = 1 while an RT task waits for a release   */
+    const void *p_pend;     /**> message a BLK_SEND task wants to post  */
+    U32         rt_period;  /**> RT period in ticks, 0 if not an RT task    */
+    U32         rt_release; /**> tick of the current RT release         */
+    struct tcb *a_prev;     /**> previous task on the active list       */
+    struct tcb *a_next;     /**> next task on the active list           */
+} TCB_COLD;
+
+/**
+ * @brief one contiguous byte ring of a mailbox
+ * @note  messages are stored back to back as <MBX_SLOT, RTX_MSG_HDR, data>,
+ *        4B aligned; a message that does not fit before the end of the ring
+ *        is placed at offset 0 and the gap is marked as padding
+ */
+typedef struct mbx_ring {
+    U8         *buf;    /**> ring storage                                */
+    U32         size;   /**> ring capacity in bytes                      */
+    U32         head;   /**> offset of the oldest message                */
+    U32         tail;   /**> offset the next message is written to       */
+    U32         used;   /**> bytes in use, padding included              */
+    U32         count;  /**> number of queued messages                   */
+    TCB        *send_q; /**> BLK_SEND tasks of this class, by priority */
+} MBX_RING;
+
+/**
+ * @brief mailbox, one ring per message priority class
+ * @note  a FIFO mailbox has a single class. A priority mailbox splits its
+ *        storage evenly into num_classes rings; bit c of map is set while
+ *        ring[c] is non-empty and the highest set bit is dequeued first.
+ *        Each ring queues its own blocked senders, a full class never
+ *        holds back another one
+ */
+typedef struct mbx {
+    MBX_RING    ring[MBX_MAX_CLASSES];
+    U32         num_classes;    /**> 0 if no mailbox, 1 for FIFO         */
+    U32         map;    /**> non-empty rings                             */
+    U32         size;   /**> total capacity in bytes                     */
+    U32         used;   /**> bytes in use over all rings                 */
+    U32         count;  /**> number of queued messages over all rings    */
+    U32         drops;  /**> sends rejected because the ring was full    */
+} MBX;
+
 /*
  *==========================================================================
  *                   GLOBAL VARIABLES DECLARATIONS
@@ -79,25 +193,34 @@ typedef struct tcb {
 // Memory related globals are defined in k_mem.c
 // kernel stack size
 extern const U32 g_k_stack_size;    // kernel stack size
-extern const U32 g_p_stack_size;    // process stack size for sys mode tasks
+extern const U32 g_p_stack_size;    // smallest process stack for sys mode tasks
 
 // task kernel stacks are statically allocated inside the OS image
 extern U32 g_k_stacks[MAX_TASKS][KERN_STACK_SIZE >> 2] __attribute__((aligned(8)));
 
-// process stack for tasks in SYS mode, statically allocated inside the OS image  */
-extern U32 g_p_stacks[MAX_TASKS][PROC_STACK_SIZE >> 2] __attribute__((aligned(8)));
+// process stacks for tasks in SYS mode are allocated from the heap, see k_alloc_p_stack
 
 extern unsigned int Image$$ZI_DATA$$ZI$$Limit; 	// Linker defined symbol
                                                 // See ARM Compiler User Guide 5.x
 
 // task related globals are defined in k_task.c
 extern TCB *gp_current_task;    // always point to the current RUNNING task
+extern U32 g_need_resched;      // RESCHED_*, acted on at the outermost SVC/IRQ exit
 
 // TCBs are statically allocated inside the OS image
 extern TCB g_tcbs[MAX_TASKS];
+extern TCB_COLD g_tcb_cold[MAX_TASKS];
 extern RTX_TASK_INFO g_null_task_info;
+
+// kernel function of each SVC number, defined in k_svc.c
+extern void (* const g_svc_table[])(void);
 extern U32 g_num_active_tasks;	// number of non-dormant tasks */
 
+static __inline TCB_COLD *k_tcb_cold(const TCB *p_tcb)
+{
+    return &g_tcb_cold[p_tcb->tid];
+}
+
 #endif // ! K_INC_H_
 
 /*
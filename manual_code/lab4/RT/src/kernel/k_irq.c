@@ -0,0 +1,257 @@
+/*
+ ****************************************************************************
+ *
+ *                  UNIVERSITY OF WATERLOO ECE 350 RTOS LAB
+ *
+ *                     Copyright 2020-2021 Yiqing Huang
+ *                          All rights reserved.
+ *
+ *  Redistribution and use in source and binary forms, with or without
+ *  modification, are permitted provided that the following conditions are met:
+ *  - Redistributions of source code must retain the above copyright
+ *    notice and the following disclaimer.
+ *
+ *
+ *  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ *  AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ *  IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ *  ARE DISCLAIMED. IN NO EVENT SHALL COPYRIGHT HOLDERS AND CONTRIBUTORS BE
+ *  LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ *  CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ *  SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ *  INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ *  CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ *  ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ *  POSSIBILITY OF SUCH DAMAGE.
+ ****************************************************************************
+ */
+
+/**************************************************************************//**
+ * @file        k_irq.c
+ * @brief       Kernel Interrupt Handlers C File
+ *
+ * @version     V1.2021.01
+ * @authors     Yiqing Huang
+ * @date        2021 JAN
+ *
+ * @details     The C side of interrupt handling: the top halves SystemInit
+ *              registers with irq_register, their bottom halves and the
+ *              C part of IRQ_Handler. Nothing in here touches the cpu
+ *              directly, the HAL provides the entry and exit paths around
+ *              c_IRQ_Handler.
+ *
+ *****************************************************************************/
+
+#include "k_irq.h"
+#include "k_task.h"
+#include "k_msg.h"
+#include "k_work.h"
+#include "k_prof.h"
+#include "Serial.h"
+#include "timer.h"
+#include "printf.h"
+
+/*
+ *===========================================================================
+ *                            GLOBAL VARIABLES
+ *===========================================================================
+ */
+
+static U32 g_tick_lat_max;      // worst tick latency seen, HPS timer counts (10 ns)
+static U32 g_rt_lat_max;        // same for HPS timer 1, above the kernel ceiling
+static U32 g_rt_count = RT_TIMER_COUNT;     // HPS timer 1 load
+static const U32 *g_irq_frame;  // interrupted context of the running handler
+
+/*
+ *===========================================================================
+ *                            FUNCTIONS
+ *===========================================================================
+ */
+
+/**************************************************************************//**
+ * @brief   hand a work item to the bottom half
+ * @return  IRQ_DONE, the work item reports what it needs when it runs.
+ *          With WORK_NO_DEFER the item runs right away in the hard
+ *          interrupt, as it used to, for comparison
+ *****************************************************************************/
+static U32 k_irq_defer(WORK_FN fn, U32 arg)
+{
+#ifdef WORK_NO_DEFER
+	return fn(arg);
+#else
+	k_work_queue(fn, arg);
+	return IRQ_DONE;
+#endif
+}
+
+/**************************************************************************//**
+ * @brief   UART0 bottom halves: echo and forward a received character,
+ *          refill the tx FIFO from DISPLAY messages
+ *****************************************************************************/
+static U32 k_work_uart_rx(U32 c)
+{
+	U32 crit;
+
+	crit = k_crit_enter();				// kernel state, keep nested handlers out
+	k_msg_uart_rx((char) c);			// echo it, hand it to the KCD
+	k_crit_exit(crit);
+	return IRQ_DONE;
+}
+
+static U32 k_work_uart_tx(U32 arg)
+{
+	U32 crit = k_crit_enter();
+
+	k_msg_uart_tx();
+	k_crit_exit(crit);
+	return IRQ_DONE;
+}
+
+/**************************************************************************//**
+ * @brief   UART0 interrupt: drain the rx FIFO into work items
+ *****************************************************************************/
+U32 k_irq_uart0(U32 irq_id, void *arg)
+{
+	int irq_type = UART0_GetIRQType();	// read once, reading clears a tx-empty irq
+	U32 rc = IRQ_DONE;
+
+	if(irq_type == UART0_IRQ_RX_DATA)	// check if interrupt type is Data Receive
+	{
+		while(UART0_GetRxDataStatus())	// read while Data Ready is valid
+		{
+			// would also clear the interrupt if last character is read
+			U32 r = k_irq_defer(k_work_uart_rx, UART0_GetRxData());
+
+			rc = (r > rc) ? r : rc;
+		}
+		return rc;
+	}
+	else if(irq_type == UART0_IRQ_TX_EMPTY)
+	{
+		return k_irq_defer(k_work_uart_tx, 0);
+	}
+	// unexpected interrupt type
+	SER_PutStr(0, "Error interrupt type!\r\n");
+	return IRQ_DONE;
+}
+
+/**************************************************************************//**
+ * @brief   tick bottom half: timeouts, and with IRQ_STATS the periodic report
+ * @note    the report busy-waits on the UART, keep it out of normal builds
+ *****************************************************************************/
+static U32 k_work_tick(U32 arg)
+{
+#ifdef IRQ_STATS
+	static unsigned int a9_timer_last = 0xFFFFFFFF; // the initial value of free-running timer
+	unsigned int a9_timer_curr;
+#endif /* IRQ_STATS */
+	U32 crit;
+
+	crit = k_crit_enter();
+	k_tsk_tick();						// expire timeouts and suspensions
+	k_tsk_account(gp_current_task);		// keep the 32-bit PMU deltas short
+	k_crit_exit(crit);
+#ifdef IRQ_STATS
+	a9_timer_curr = timer_get_current_val(2);	//get the current value of the free running timer
+	if ((a9_timer_last - a9_timer_curr) > 500000U)
+	{
+		printf("%d ms passed! max tick latency %u ns, rt timer %u ns\r\n",
+		       ((a9_timer_last - a9_timer_curr)/1000U), g_tick_lat_max * 10U,
+		       g_rt_lat_max * 10U);
+		printf("max hard irq time: uart %u us, tick %u us, work drops %u\r\n",
+		       irq_get_max_time(UART0_Rx_IRQ_ID), irq_get_max_time(HPS_TIMER0_IRQ_ID),
+		       k_work_drops());
+		a9_timer_last = a9_timer_curr;
+	}
+#endif /* IRQ_STATS */
+	return IRQ_DONE;
+}
+
+/**************************************************************************//**
+ * @brief   HPS timer 0 interrupt, the kernel tick
+ *****************************************************************************/
+U32 k_irq_tick(U32 irq_id, void *arg)
+{
+	U32 lat = KERN_TICK_COUNT - timer_get_current_val(0);	// counts since the timer expired
+
+	timer_clear_irq(0);
+	if (lat > g_tick_lat_max)
+	{
+		g_tick_lat_max = lat;
+	}
+	return k_irq_defer(k_work_tick, 0);
+}
+
+/**************************************************************************//**
+ * @brief   other timer interrupts, arg is the timer index
+ * @note    HPS timer 1 sits above the kernel ceiling, its latency is the
+ *          jitter a hard real-time source would see. With RT_TIMER_FIQ it
+ *          comes in as FIQ and must stay clear of kernel state
+ *****************************************************************************/
+U32 k_irq_timer(U32 irq_id, void *arg)
+{
+	if ((int) arg == 1)
+	{
+		U32 lat = g_rt_count - timer_get_current_val(1);
+
+		if (lat > g_rt_lat_max)
+		{
+			g_rt_lat_max = lat;
+		}
+		k_prof_sample(g_irq_frame);
+	}
+	timer_clear_irq((int) arg);
+	return IRQ_DONE;
+}
+
+/**************************************************************************//**
+ * @brief   reload HPS timer 1 with a new period
+ * @param   count   period in 10 ns timer counts
+ *****************************************************************************/
+void k_rt_timer_set(U32 count)
+{
+	g_rt_count = count;
+	config_hps_timer(1, count, 1, 0);
+}
+
+/**************************************************************************//**
+ * @brief   C part of IRQ_Handler, one table lookup per interrupt
+ * @param   frame   the interrupted context as IRQ_Handler saved it
+ * @note    runs on the interrupt stack, irq_dispatch enables IRQs around
+ *          the handler and ends the interrupt before returning.
+ *          The outermost level then runs the deferred work with IRQs
+ *          enabled; nested interrupts only add to the queue.
+ *****************************************************************************/
+K_HOT void c_IRQ_Handler(const U32 *frame)
+{
+	const U32 *outer = g_irq_frame;		// a nested entry restores it on the way out
+	U32 rc;
+
+	g_irq_frame = frame;
+	rc = irq_dispatch();
+	g_irq_frame = outer;
+
+	if (g_irq_nest == 1)
+	{
+		// re-check with IRQs masked so that no item queued late is left behind
+		while (k_work_pending())
+		{
+			U32 r;
+
+			__enable_irq();
+			r = k_work_run();
+			__disable_irq();
+			rc = (r > rc) ? r : rc;
+		}
+	}
+	if (rc != IRQ_DONE)
+	{
+		k_tsk_need_resched(rc);			// IRQ_* and RESCHED_* share their values
+	}
+}
+
+/*
+ *===========================================================================
+ *                             END OF FILE
+ *===========================================================================
+ */
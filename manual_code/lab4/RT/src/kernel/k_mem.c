@@ -44,11 +44,42 @@
  */
 
 #include "k_mem.h"
+#include "k_task.h"
 #include "Serial.h"
 #ifdef DEBUG_0
 #include "printf.h"
 #endif  /* DEBUG_0 */
 
+/*
+ *==========================================================================
+ *                            MACROS
+ *==========================================================================
+ */
+
+#define MEM_ALIGN(x)    (((U32)(x) + 7U) & ~7U)     // 8B aligned, as AAPCS wants
+#define MEM_MAX_SIZE    (0xFFFFFFFFU - sizeof(MEM_BLK) - 7U)   // largest size MEM_ALIGN does not wrap
+#define MEM_MAGIC       0xA110C000U                 // tags an allocated block
+#define MEM_MAGIC_MASK  0xFFFFFF00U                 // low byte holds the owner tid
+
+/*
+ *==========================================================================
+ *                            STRUCTURES
+ *==========================================================================
+ */
+
+/**
+ * @brief   header in front of every heap block
+ * @note    free blocks are linked in address order;
+ *          allocated blocks carry MEM_MAGIC | owner tid in the tag
+ */
+typedef struct mem_blk {
+    union {
+        struct mem_blk *next;   /**> next free block                */
+        U32             tag;    /**> MEM_MAGIC | owner tid          */
+    } u;
+    U32                 size;   /**> block size including header    */
+} MEM_BLK;
+
 /*
  *==========================================================================
  *                            GLOBAL VARIABLES
@@ -56,14 +87,19 @@
  */
 // kernel stack size, referred by startup_a9.s
 const U32 g_k_stack_size = KERN_STACK_SIZE;
-// task proc space stack size in bytes, referred by system_a9.c
+// smallest task proc space stack in bytes, user stacks come from the heap
 const U32 g_p_stack_size = PROC_STACK_SIZE;
 
 // task kernel stacks
 U32 g_k_stacks[MAX_TASKS][KERN_STACK_SIZE >> 2] __attribute__((aligned(8)));
 
-//process stack for tasks in SYS mode
-U32 g_p_stacks[MAX_TASKS][PROC_STACK_SIZE >> 2] __attribute__((aligned(8)));
+#ifdef KERN_SRP
+// the one user stack all RT jobs run on
+static U32 g_srp_stack[SRP_STACK_SIZE >> 2] __attribute__((aligned(8)));
+#endif
+
+// free list of the heap, address ordered
+static MEM_BLK *g_free_list = NULL;
 
 /*
  *===========================================================================
@@ -76,10 +112,34 @@ U32* k_alloc_k_stack(task_t tid)
     return g_k_stacks[tid+1];
 }
 
-U32* k_alloc_p_stack(task_t tid)
+/**************************************************************************//**
+ * @brief       carve the user stack of a task out of the heap
+ * @return      the stack base (high address); NULL if the heap is full
+ * @param       size    stack size in bytes, a multiple of 8
+ * @note        a task cannot hand its own stack to mem_dealloc, see
+ *              k_mem_alloc_kern. k_free_p_stack gives it back
+ *****************************************************************************/
+U32* k_alloc_p_stack(U32 size)
+{
+    U32 *p_stack = k_mem_alloc_kern(size);
+
+    if (p_stack == NULL) {
+        return NULL;
+    }
+    return p_stack + (size >> 2);
+}
+
+void k_free_p_stack(U32 *p_stack_hi, U32 size)
+{
+    k_mem_free(p_stack_hi - (size >> 2));
+}
+
+#ifdef KERN_SRP
+U32* k_alloc_srp_stack(void)
 {
-    return g_p_stacks[tid+1];
+    return g_srp_stack + (SRP_STACK_SIZE >> 2);
 }
+#endif
 
 int k_mem_init(void) {
     unsigned int end_addr = (unsigned int) &Image$$ZI_DATA$$ZI$$Limit;
@@ -87,28 +147,139 @@ int k_mem_init(void) {
     printf("k_mem_init: image ends at 0x%x\r\n", end_addr);
     printf("k_mem_init: RAM ends at 0x%x\r\n", RAM_END);
 #endif /* DEBUG_0 */
+    // one free block spanning everything between the image and RAM_END
+    g_free_list = (MEM_BLK *) MEM_ALIGN(end_addr);
+    g_free_list->u.next = NULL;
+    g_free_list->size = ((RAM_END + 1U) & ~7U) - (U32) g_free_list;
     return RTX_OK;
 }
 
+/**************************************************************************//**
+ * @brief       first-fit allocation
+ * @return      8B aligned pointer to at least size bytes; NULL on failure
+ * @param       size    requested number of bytes
+ *****************************************************************************/
 void* k_mem_alloc(size_t size) {
+    MEM_BLK **pp_blk = &g_free_list;
+    U32 need;
+
 #ifdef DEBUG_0
     printf("k_mem_alloc: requested memory size = %d\r\n", size);
 #endif /* DEBUG_0 */
+    if (size == 0 || size > MEM_MAX_SIZE) {
+        return NULL;
+    }
+    need = MEM_ALIGN(size + sizeof(MEM_BLK));
+
+    while (*pp_blk != NULL) {
+        MEM_BLK *p_blk = *pp_blk;
+        if (p_blk->size >= need) {
+            if (p_blk->size - need >= sizeof(MEM_BLK) * 2) {
+                // split, the tail stays on the free list
+                MEM_BLK *p_rest = (MEM_BLK *) ((U8 *) p_blk + need);
+                p_rest->u.next = p_blk->u.next;
+                p_rest->size = p_blk->size - need;
+                p_blk->size = need;
+                *pp_blk = p_rest;
+            } else {
+                *pp_blk = p_blk->u.next;
+            }
+            p_blk->u.tag = MEM_MAGIC | ((gp_current_task == NULL) ? TID_NULL : gp_current_task->tid);
+            return p_blk + 1;
+        }
+        pp_blk = &p_blk->u.next;
+    }
     return NULL;
 }
 
+/**************************************************************************//**
+ * @brief       first-fit allocation of kernel owned memory
+ * @return      8B aligned pointer to at least size bytes; NULL on failure
+ * @note        the block is tagged with TID_NULL, not the caller, so
+ *              mem_dealloc from a task rejects it. Only k_mem_free
+ *              returns it to the heap
+ *****************************************************************************/
+void* k_mem_alloc_kern(size_t size) {
+    void *ptr = k_mem_alloc(size);
+
+    if (ptr != NULL) {
+        ((MEM_BLK *) ptr - 1)->u.tag = MEM_MAGIC | TID_NULL;
+    }
+    return ptr;
+}
+
+/**************************************************************************//**
+ * @brief       return a block of the caller to the heap
+ * @return      RTX_OK on success; RTX_ERR if ptr was not allocated
+ *              or is owned by another task
+ *****************************************************************************/
 int k_mem_dealloc(void *ptr) {
+    MEM_BLK *p_blk;
+
 #ifdef DEBUG_0
     printf("k_mem_dealloc: freeing 0x%x\r\n", (U32) ptr);
 #endif /* DEBUG_0 */
+    if (ptr == NULL) {
+        return RTX_OK;
+    }
+
+    p_blk = (MEM_BLK *) ptr - 1;
+    if ((p_blk->u.tag & MEM_MAGIC_MASK) != MEM_MAGIC) {
+        return RTX_ERR;
+    }
+    if (gp_current_task != NULL && (p_blk->u.tag & 0xFF) != gp_current_task->tid) {
+        return RTX_ERR;
+    }
+    k_mem_free(ptr);
     return RTX_OK;
 }
 
+/**************************************************************************//**
+ * @brief       return a block to the heap whoever owns it, merging it with
+ *              its free neighbours, for the kernel cleaning up after a task
+ * @param       ptr     a block k_mem_alloc returned
+ *****************************************************************************/
+void k_mem_free(void *ptr) {
+    MEM_BLK *p_blk = (MEM_BLK *) ptr - 1;
+    MEM_BLK *p_prev = NULL;
+    MEM_BLK *p_next = g_free_list;
+
+    while (p_next != NULL && p_next < p_blk) {
+        p_prev = p_next;
+        p_next = p_next->u.next;
+    }
+
+    p_blk->u.next = p_next;
+    if (p_next != NULL && (U8 *) p_blk + p_blk->size == (U8 *) p_next) {
+        p_blk->size += p_next->size;
+        p_blk->u.next = p_next->u.next;
+    }
+    if (p_prev == NULL) {
+        g_free_list = p_blk;
+    } else if ((U8 *) p_prev + p_prev->size == (U8 *) p_blk) {
+        p_prev->size += p_blk->size;
+        p_prev->u.next = p_blk->u.next;
+    } else {
+        p_prev->u.next = p_blk;
+    }
+}
+
+/**************************************************************************//**
+ * @brief       count free blocks smaller than size bytes
+ * @param       size    block size threshold, headers included
+ *****************************************************************************/
 int k_mem_count_extfrag(size_t size) {
+    int n = 0;
+
 #ifdef DEBUG_0
     printf("k_mem_extfrag: size = %d\r\n", size);
 #endif /* DEBUG_0 */
-    return RTX_OK;
+    for (MEM_BLK *p_blk = g_free_list; p_blk != NULL; p_blk = p_blk->u.next) {
+        if (p_blk->size < size) {
+            n++;
+        }
+    }
+    return n;
 }
 
 /*
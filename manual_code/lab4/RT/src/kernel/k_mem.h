@@ -50,10 +50,14 @@
  */
 int     k_mem_init          (void);
 void   *k_mem_alloc         (size_t size);
+void   *k_mem_alloc_kern    (size_t size);
 int     k_mem_dealloc       (void *ptr);
+void    k_mem_free          (void *ptr);
 int     k_mem_count_extfrag (size_t size);
 U32    *k_alloc_k_stack     (task_t tid);
-U32    *k_alloc_p_stack     (task_t tid);
+U32    *k_alloc_p_stack     (U32 size);
+void    k_free_p_stack      (U32 *p_stack_hi, U32 size);
+U32    *k_alloc_srp_stack   (void);
 #endif // ! K_MEM_H_
 
 /*
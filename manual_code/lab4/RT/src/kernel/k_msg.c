@@ -3,45 +3,664 @@
  * @brief:  kernel message passing routines
  * @author: Yiqing Huang
  * @date:   2020/10/09
+ * @note:   each mailbox is a single byte ring sized at creation time.
+ *          Sending copies the message (header included) into the ring once,
+ *          receiving copies it out once. Neither path allocates memory.
+ *          A priority mailbox keeps one such ring per message class.
+ *          A full ring can park senders (send_msg_timed); whenever space
+ *          frees up their messages are moved in, highest priority first.
+ *          Senders are parked per class, so a blocked bulk sender does not
+ *          stand in the way of messages for another class.
  */
 
 #include "k_msg.h"
+#include "k_mem.h"
+#include "k_task.h"
+#include "Serial.h"
 
 #ifdef DEBUG_0
 #include "printf.h"
 #endif /* ! DEBUG_0 */
 
+/*
+ *==========================================================================
+ *                            MACROS
+ *==========================================================================
+ */
+
+#define MBX_ALIGN(x)    (((U32)(x) + 3U) & ~3U)
+#define MBX_SLOT_PAD    0x01    /* slot marks unused space up to the end of the ring */
+
+/*
+ *==========================================================================
+ *                            STRUCTURES
+ *==========================================================================
+ */
+
+/**
+ * @brief   per-message bookkeeping stored in front of RTX_MSG_HDR
+ */
+typedef struct mbx_slot {
+    task_t      sender;         /**> sender tid                     */
+    U8          flags;          /**> MBX_SLOT_PAD or 0              */
+    U16         rsvd;
+} MBX_SLOT;
+
+/*
+ *==========================================================================
+ *                            GLOBAL VARIABLES
+ *==========================================================================
+ */
+
+static MBX  g_mbx[MAX_TASKS];       // task mailboxes, indexed by tid
+static MBX  g_uart_mbx;             // console output, owned by TID_UART_IRQ
+static U32  g_uart_tx_off;          // bytes of the head DISPLAY message already sent
+
+/*
+ *===========================================================================
+ *                            FUNCTIONS
+ *===========================================================================
+ */
+
+static void k_msg_copy(U8 *dst, const U8 *src, U32 len)
+{
+    while (len-- > 0) {
+        *dst++ = *src++;
+    }
+}
+
+static MBX *k_mbx_of(task_t tid)
+{
+    if (tid == TID_UART_IRQ) {
+        return &g_uart_mbx;
+    }
+    if (tid >= MAX_TASKS || g_mbx[tid].num_classes == 0) {
+        return NULL;
+    }
+    return &g_mbx[tid];
+}
+
+/**
+ * @brief   append a message to a ring
+ * @return  RTX_OK on success, RTX_ERR if there is no contiguous room
+ * @note    O(1): at most one padding slot is written at the wrap point
+ */
+static int k_ring_put(MBX_RING *p_ring, task_t sender, const RTX_MSG_HDR *p_msg)
+{
+    U32 need = MBX_ALIGN(sizeof(MBX_SLOT) + p_msg->length);
+    U32 pad  = 0;
+    U32 pos;
+    MBX_SLOT *p_slot;
+
+    if (p_ring->used == 0) {
+        p_ring->head = p_ring->tail = 0;    // restart at 0 for the longest run
+    }
+    if (p_ring->used + need > p_ring->size) {
+        return RTX_ERR;
+    }
+
+    pos = p_ring->tail;
+    if (p_ring->tail >= p_ring->head) {
+        // free space is [tail, size) followed by [0, head)
+        if (p_ring->size - p_ring->tail < need) {
+            if (p_ring->head < need) {
+                return RTX_ERR;
+            }
+            pad = p_ring->size - p_ring->tail;
+            ((MBX_SLOT *) (p_ring->buf + p_ring->tail))->flags = MBX_SLOT_PAD;
+            pos = 0;
+        }
+    } else if (p_ring->head - p_ring->tail < need) {
+        // free space is [tail, head)
+        return RTX_ERR;
+    }
+
+    p_slot = (MBX_SLOT *) (p_ring->buf + pos);
+    p_slot->sender = sender;
+    p_slot->flags  = 0;
+    k_msg_copy((U8 *) (p_slot + 1), (const U8 *) p_msg, p_msg->length);
+
+    p_ring->tail = pos + need;
+    if (p_ring->tail == p_ring->size) {
+        p_ring->tail = 0;
+    }
+    p_ring->used += pad + need;
+    p_ring->count++;
+    return RTX_OK;
+}
+
+/**
+ * @brief   oldest message in a non-empty ring, left in place
+ */
+static MBX_SLOT *k_ring_peek(MBX_RING *p_ring)
+{
+    MBX_SLOT *p_slot = (MBX_SLOT *) (p_ring->buf + p_ring->head);
+
+    if (p_slot->flags & MBX_SLOT_PAD) {
+        p_ring->used -= p_ring->size - p_ring->head;
+        p_ring->head = 0;
+        p_slot = (MBX_SLOT *) p_ring->buf;
+    }
+    return p_slot;
+}
+
+/**
+ * @brief   drop the message k_ring_peek returned
+ * @return  number of bytes freed
+ */
+static U32 k_ring_pop(MBX_RING *p_ring, MBX_SLOT *p_slot)
+{
+    U32 len = MBX_ALIGN(sizeof(MBX_SLOT) + ((RTX_MSG_HDR *) (p_slot + 1))->length);
+
+    p_ring->head += len;
+    if (p_ring->head == p_ring->size) {
+        p_ring->head = 0;
+    }
+    p_ring->used -= len;
+    p_ring->count--;
+    return len;
+}
+
+/**
+ * @brief   ring a message is queued on, by the priority field of its type
+ */
+static MBX_RING *k_mbx_ring(MBX *p_mbx, const RTX_MSG_HDR *p_msg)
+{
+    U32 cls = MSG_PRIO_OF(p_msg->type);
+
+    if (cls >= p_mbx->num_classes) {
+        cls = p_mbx->num_classes - 1;
+    }
+    return &p_mbx->ring[cls];
+}
+
+/**
+ * @brief   append a message to the ring of its class
+ * @return  RTX_OK on success, RTX_ERR if there is no contiguous room
+ */
+static int k_mbx_put(MBX *p_mbx, task_t sender, const RTX_MSG_HDR *p_msg)
+{
+    MBX_RING *p_ring = k_mbx_ring(p_mbx, p_msg);
+    U32 used = p_ring->used;
+
+    if (k_ring_put(p_ring, sender, p_msg) != RTX_OK) {
+        return RTX_ERR;
+    }
+    p_mbx->used += p_ring->used - used;
+    p_mbx->count++;
+    p_mbx->map |= 1U << (p_ring - p_mbx->ring);
+    return RTX_OK;
+}
+
+/**
+ * @brief   next message to deliver, left in place
+ * @return  pointer to the slot, NULL if the mailbox is empty
+ * @note    O(1): the most urgent non-empty ring is found with one CLZ
+ */
+static MBX_SLOT *k_mbx_peek(MBX *p_mbx)
+{
+    MBX_RING *p_ring;
+    MBX_SLOT *p_slot;
+    U32 used;
+
+    if (p_mbx->count == 0) {
+        return NULL;
+    }
+    p_ring = &p_mbx->ring[31 - __clz(p_mbx->map)];
+    used = p_ring->used;
+    p_slot = k_ring_peek(p_ring);
+    p_mbx->used -= used - p_ring->used;
+    return p_slot;
+}
+
+/**
+ * @brief   drop the message k_mbx_peek returned
+ */
+static void k_mbx_pop(MBX *p_mbx, MBX_SLOT *p_slot)
+{
+    MBX_RING *p_ring = k_mbx_ring(p_mbx, (RTX_MSG_HDR *) (p_slot + 1));
+
+    p_mbx->used -= k_ring_pop(p_ring, p_slot);
+    p_mbx->count--;
+    if (p_ring->count == 0) {
+        p_mbx->map &= ~(1U << (p_ring - p_mbx->ring));
+    }
+}
+
+/**
+ * @brief   carve a mailbox of num_classes equal rings out of one allocation
+ * @return  RTX_OK on success, RTX_ERR on failure
+ * @note    each ring is size / num_classes rounded up to 4B, so the total
+ *          may exceed size by up to 3 bytes per class. p_mbx->size and
+ *          mbx_get report the real total
+ */
+static int k_mbx_init(MBX *p_mbx, size_t size, U32 num_classes)
+{
+    U32 ring_size;
+    U8 *buf;
+
+    if (num_classes == 0 || num_classes > MBX_MAX_CLASSES) {
+        return RTX_ERR;
+    }
+    ring_size = MBX_ALIGN(size / num_classes);
+    if (size < MIN_MBX_SIZE || ring_size == 0) {
+        return RTX_ERR;
+    }
+    buf = k_mem_alloc_kern(ring_size * num_classes);   // no task may mem_dealloc it
+    if (buf == NULL) {
+        return RTX_ERR;
+    }
+
+    for (U32 i = 0; i < num_classes; i++) {
+        MBX_RING *p_ring = &p_mbx->ring[i];
+
+        p_ring->buf   = buf + i * ring_size;
+        p_ring->size  = ring_size;
+        p_ring->head  = 0;
+        p_ring->tail  = 0;
+        p_ring->used  = 0;
+        p_ring->count = 0;
+        p_ring->send_q = NULL;
+    }
+    p_mbx->num_classes = num_classes;
+    p_mbx->map    = 0;
+    p_mbx->size   = ring_size * num_classes;
+    p_mbx->used   = 0;
+    p_mbx->count  = 0;
+    p_mbx->drops  = 0;
+    return RTX_OK;
+}
+
+/**
+ * @brief   mailbox of receiver_tid if it can ever hold the message
+ * @return  NULL if there is no such mailbox or the message is invalid
+ */
+static MBX *k_mbx_check(task_t receiver_tid, const RTX_MSG_HDR *p_msg)
+{
+    MBX *p_mbx = k_mbx_of(receiver_tid);
+
+    if (p_mbx == NULL || p_msg == NULL ||
+        p_msg->length < sizeof(RTX_MSG_HDR) + MIN_MSG_SIZE ||
+        MBX_ALIGN(sizeof(MBX_SLOT) + p_msg->length) > k_mbx_ring(p_mbx, p_msg)->size) {
+        return NULL;
+    }
+    return p_mbx;
+}
+
+/**
+ * @brief   let the receiver know a message arrived
+ */
+static void k_mbx_notify(task_t receiver_tid)
+{
+    if (receiver_tid == TID_UART_IRQ) {
+        UART0_EnableTxIRQ();
+        return;
+    }
+    if (g_tcbs[receiver_tid].state == BLK_MSG) {
+        k_tsk_wake(&g_tcbs[receiver_tid], RTX_OK);
+    }
+}
+
+/**
+ * @brief   move the messages of blocked senders into their rings while
+ *          they fit, class by class
+ * @note    within a class the head sender holds back the ones behind it
+ *          until its own message fits, so a large message is not starved
+ *          by small ones. It never holds back another class
+ */
+static void k_mbx_admit(MBX *p_mbx)
+{
+    for (U32 c = 0; c < p_mbx->num_classes; c++) {
+        MBX_RING *p_ring = &p_mbx->ring[c];
+
+        while (p_ring->send_q != NULL) {
+            TCB *p_tcb = p_ring->send_q;
+
+            if (k_mbx_put(p_mbx, p_tcb->tid, k_tcb_cold(p_tcb)->p_pend) != RTX_OK) {
+                break;
+            }
+            k_tsk_wake(p_tcb, RTX_OK);
+        }
+    }
+}
+
+/**
+ * @brief   deliver a message on behalf of a task or an interrupt handler
+ * @return  RTX_OK on success, RTX_ERR on failure
+ * @note    readies the receiver if it was blocked on its mailbox,
+ *          does not reschedule. Never overtakes blocked senders of the
+ *          message's class, other classes do not matter.
+ */
+int k_mbx_send(task_t sender, task_t receiver_tid, const void *buf)
+{
+    const RTX_MSG_HDR *p_msg = (const RTX_MSG_HDR *) buf;
+    MBX *p_mbx = k_mbx_check(receiver_tid, p_msg);
+
+    if (p_mbx == NULL) {
+        return RTX_ERR;
+    }
+    if (k_mbx_ring(p_mbx, p_msg)->send_q != NULL ||
+        k_mbx_put(p_mbx, sender, p_msg) != RTX_OK) {
+        p_mbx->drops++;
+        return RTX_ERR;
+    }
+    k_mbx_notify(receiver_tid);
+    return RTX_OK;
+}
+
 int k_mbx_create(size_t size) {
 #ifdef DEBUG_0
     printf("k_mbx_create: size = %d\r\n", size);
 #endif /* DEBUG_0 */
-    return 0;
+    return k_mbx_create_prio(size, 1);
+}
+
+/**
+ * @brief   create a mailbox that delivers by message priority
+ * @param   num_classes number of priority classes, 1 gives a FIFO mailbox.
+ *                      size is split evenly among the classes, each share
+ *                      rounded up to 4B; priorities above num_classes - 1
+ *                      share the most urgent class
+ * @return  the owner tid on success, RTX_ERR on failure
+ */
+int k_mbx_create_prio(size_t size, U32 num_classes) {
+#ifdef DEBUG_0
+    printf("k_mbx_create_prio: size = %d, num_classes = %d\r\n", size, num_classes);
+#endif /* DEBUG_0 */
+    return k_mbx_create_tid(gp_current_task->tid, size, num_classes);
+}
+
+/**
+ * @brief   create the mailbox of task tid, k_tsk_create_rt does it for
+ *          the task it creates
+ * @return  tid on success, RTX_ERR on failure
+ */
+int k_mbx_create_tid(task_t tid, size_t size, U32 num_classes) {
+    MBX *p_mbx = &g_mbx[tid];
+
+    if (p_mbx->num_classes != 0 || k_mbx_init(p_mbx, size, num_classes) != RTX_OK) {
+        return RTX_ERR;
+    }
+    return tid;
+}
+
+/**
+ * @brief   free the mailbox of a task that exits, so that the next task
+ *          given its tid starts without one
+ * @note    tasks blocked sending to it get RTX_ERR
+ */
+void k_mbx_free(task_t tid) {
+    MBX *p_mbx = &g_mbx[tid];
+
+    if (p_mbx->num_classes == 0) {
+        return;
+    }
+    for (U32 c = 0; c < p_mbx->num_classes; c++) {
+        while (p_mbx->ring[c].send_q != NULL) {
+            k_tsk_wake(p_mbx->ring[c].send_q, RTX_ERR);
+        }
+    }
+    k_mem_free(p_mbx->ring[0].buf);
+    p_mbx->num_classes = 0;
 }
 
 int k_send_msg(task_t receiver_tid, const void *buf) {
 #ifdef DEBUG_0
     printf("k_send_msg: receiver_tid = %d, buf=0x%x\r\n", receiver_tid, buf);
 #endif /* DEBUG_0 */
-    return 0;
+    return k_mbx_send(gp_current_task->tid, receiver_tid, buf);
+}
+
+/**
+ * @brief   send, waiting up to tv for room in the receiver's mailbox
+ * @param   tv  NULL waits forever, a zero timeout does not block
+ * @return  RTX_OK once the message is in the mailbox, RTX_ERR on timeout
+ * @note    a blocked sender holds a pointer to buf, the message is copied
+ *          by whoever frees up the space
+ */
+int k_send_msg_timed(task_t receiver_tid, const void *buf, TIMEVAL *tv) {
+    const RTX_MSG_HDR *p_msg = (const RTX_MSG_HDR *) buf;
+    MBX *p_mbx = k_mbx_check(receiver_tid, p_msg);
+    MBX_RING *p_ring;
+
+#ifdef DEBUG_0
+    printf("k_send_msg_timed: receiver_tid = %d, buf=0x%x\r\n", receiver_tid, buf);
+#endif /* DEBUG_0 */
+    if (p_mbx == NULL) {
+        return RTX_ERR;
+    }
+    p_ring = k_mbx_ring(p_mbx, p_msg);
+    if (p_ring->send_q == NULL &&
+        k_mbx_put(p_mbx, gp_current_task->tid, p_msg) == RTX_OK) {
+        k_mbx_notify(receiver_tid);
+        return RTX_OK;
+    }
+
+    // nobody would ever drain our own mailbox while we wait on it
+    if (receiver_tid == gp_current_task->tid ||
+        (tv != NULL && tv->sec == 0 && tv->usec == 0)) {
+        p_mbx->drops++;
+        return RTX_ERR;
+    }
+    k_tcb_cold(gp_current_task)->p_pend = p_msg;
+    if (k_tsk_block(BLK_SEND, &p_ring->send_q, tv) != RTX_OK) {
+        p_mbx->drops++;
+        return RTX_ERR;
+    }
+    return RTX_OK;
 }
 
 int k_recv_msg(task_t *sender_tid, void *buf, size_t len) {
 #ifdef DEBUG_0
     printf("k_recv_msg: sender_tid  = 0x%x, buf=0x%x, len=%d\r\n", sender_tid, buf, len);
 #endif /* DEBUG_0 */
-    return 0;
+    return k_recv_msg_timed(sender_tid, buf, len, NULL);
+}
+
+/**
+ * @brief   receive, waiting up to tv for a message to arrive
+ * @param   tv  NULL waits forever, a zero timeout does not block
+ * @return  RTX_OK on success, RTX_ERR on timeout or error
+ */
+int k_recv_msg_timed(task_t *sender_tid, void *buf, size_t len, TIMEVAL *tv) {
+    MBX *p_mbx = k_mbx_of(gp_current_task->tid);
+
+#ifdef DEBUG_0
+    printf("k_recv_msg_timed: sender_tid  = 0x%x, buf=0x%x, len=%d\r\n", sender_tid, buf, len);
+#endif /* DEBUG_0 */
+    if (p_mbx == NULL || buf == NULL) {
+        return RTX_ERR;
+    }
+    if (p_mbx->count == 0) {
+        if (tv != NULL && tv->sec == 0 && tv->usec == 0) {
+            return RTX_ERR;
+        }
+        if (k_tsk_block(BLK_MSG, NULL, tv) != RTX_OK) {
+            return RTX_ERR;
+        }
+    }
+    return k_recv_msg_nb(sender_tid, buf, len);
 }
 
 int k_recv_msg_nb(task_t *sender_tid, void *buf, size_t len) {
+    MBX *p_mbx = k_mbx_of(gp_current_task->tid);
+    MBX_SLOT *p_slot;
+    RTX_MSG_HDR *p_msg;
+
 #ifdef DEBUG_0
     printf("k_recv_msg_nb: sender_tid  = 0x%x, buf=0x%x, len=%d\r\n", sender_tid, buf, len);
 #endif /* DEBUG_0 */
-    return 0;
+    if (p_mbx == NULL || buf == NULL) {
+        return RTX_ERR;
+    }
+
+    p_slot = k_mbx_peek(p_mbx);
+    if (p_slot == NULL) {
+        return RTX_ERR;
+    }
+
+    // a message that does not fit the buffer is discarded
+    p_msg = (RTX_MSG_HDR *) (p_slot + 1);
+    if (p_msg->length > len) {
+        k_mbx_pop(p_mbx, p_slot);
+        k_mbx_admit(p_mbx);
+        return RTX_ERR;
+    }
+
+    k_msg_copy((U8 *) buf, (const U8 *) p_msg, p_msg->length);
+    if (sender_tid != NULL) {
+        *sender_tid = p_slot->sender;
+    }
+    k_mbx_pop(p_mbx, p_slot);
+    k_mbx_admit(p_mbx);
+    return RTX_OK;
+}
+
+/**
+ * @brief   drain up to max_msgs messages in one call
+ * @param   sender_tids side array, sender_tids[i] is the sender of message i,
+ *                      may be NULL
+ * @param   buf         messages are stored back to back, each one starting
+ *                      on a 4B boundary (see MSG_BATCH_NEXT)
+ * @return  number of messages copied, RTX_ERR on error
+ * @note    blocks like recv_msg until at least one message is queued.
+ *          Stops at the first message that does not fit the rest of buf;
+ *          if not even the first message fits it is discarded, as in
+ *          recv_msg_nb. Blocked senders are admitted once per batch.
+ */
+int k_recv_msg_batch(task_t *sender_tids, void *buf, size_t len, int max_msgs) {
+    MBX *p_mbx = k_mbx_of(gp_current_task->tid);
+    MBX_SLOT *p_slot;
+    U32 off = 0;
+    int n = 0;
+
+#ifdef DEBUG_0
+    printf("k_recv_msg_batch: sender_tids = 0x%x, buf=0x%x, len=%d, max_msgs=%d\r\n",
+           sender_tids, buf, len, max_msgs);
+#endif /* DEBUG_0 */
+    if (p_mbx == NULL || buf == NULL || max_msgs <= 0) {
+        return RTX_ERR;
+    }
+    if (p_mbx->count == 0 && k_tsk_block(BLK_MSG, NULL, NULL) != RTX_OK) {
+        return RTX_ERR;
+    }
+
+    while (n < max_msgs && (p_slot = k_mbx_peek(p_mbx)) != NULL) {
+        RTX_MSG_HDR *p_msg = (RTX_MSG_HDR *) (p_slot + 1);
+
+        if (off + p_msg->length > len) {
+            if (n == 0) {
+                k_mbx_pop(p_mbx, p_slot);
+                n = RTX_ERR;
+            }
+            break;
+        }
+        k_msg_copy((U8 *) buf + off, (const U8 *) p_msg, p_msg->length);
+        if (sender_tids != NULL) {
+            sender_tids[n] = p_slot->sender;
+        }
+        off += MBX_ALIGN(p_msg->length);
+        n++;
+        k_mbx_pop(p_mbx, p_slot);
+    }
+
+    k_mbx_admit(p_mbx);
+    return n;
 }
 
 int k_mbx_ls(task_t *buf, int count) {
+    int n = 0;
+
 #ifdef DEBUG_0
     printf("k_mbx_ls: buf=0x%x, count=%d\r\n", buf, count);
 #endif /* DEBUG_0 */
-    return 0;
+    if (buf == NULL || count <= 0) {
+        return RTX_ERR;
+    }
+    for (int i = 0; i < MAX_TASKS && n < count; i++) {
+        if (g_mbx[i].num_classes != 0 && g_tcbs[i].state != DORMANT) {
+            buf[n++] = i;
+        }
+    }
+    return n;
+}
+
+/**
+ * @brief   per-mailbox statistics, read straight from the ring counters
+ */
+int k_mbx_get(task_t tid, RTX_MBX_INFO *buf) {
+    MBX *p_mbx = k_mbx_of(tid);
+
+#ifdef DEBUG_0
+    printf("k_mbx_get: tid=%d, buf=0x%x\r\n", tid, buf);
+#endif /* DEBUG_0 */
+    if (p_mbx == NULL || buf == NULL) {
+        return RTX_ERR;
+    }
+    buf->tid   = tid;
+    buf->size  = p_mbx->size;
+    buf->used  = p_mbx->used;
+    buf->count = p_mbx->count;
+    buf->drops = p_mbx->drops;
+    return RTX_OK;
+}
+
+/**
+ * @brief   console mailbox set up, called once at boot
+ */
+int k_msg_init(void) {
+    return k_mbx_init(&g_uart_mbx, UART_MBX_SIZE, 1);
+}
+
+/**
+ * @brief   echo a received character on the console and forward it to the
+ *          KCD as a KEY_IN message
+ * @return  TRUE if the KCD was blocked waiting for it
+ * @note    called from the UART bottom half. The echo is queued as a
+ *          DISPLAY message like any other console output, it is dropped
+ *          rather than waited for when the console ring is full
+ */
+BOOL k_msg_uart_rx(char c) {
+    U8 buf[sizeof(RTX_MSG_HDR) + 1];
+    RTX_MSG_HDR *p_hdr = (RTX_MSG_HDR *) buf;
+    BOOL blocked = (g_tcbs[TID_KCD].state == BLK_MSG);
+
+    p_hdr->length = sizeof(buf);
+    p_hdr->type = DISPLAY;
+    buf[sizeof(RTX_MSG_HDR)] = c;
+    k_mbx_send(TID_UART_IRQ, TID_UART_IRQ, buf);
+    p_hdr->type = KEY_IN;
+    buf[sizeof(RTX_MSG_HDR)] = c;
+    return (k_mbx_send(TID_UART_IRQ, TID_KCD, buf) == RTX_OK) && blocked;
+}
+
+/**
+ * @brief   feed the UART transmitter from queued DISPLAY messages
+ * @note    called from the UART interrupt handler when the tx FIFO drains.
+ *          Characters are sent straight out of the ring; the message is
+ *          popped once its last character is in the FIFO.
+ */
+void k_msg_uart_tx(void) {
+    int room = UART0_TX_FIFO_SIZE;
+    MBX_SLOT *p_slot;
+
+    while ((p_slot = k_mbx_peek(&g_uart_mbx)) != NULL) {
+        RTX_MSG_HDR *p_msg = (RTX_MSG_HDR *) (p_slot + 1);
+        char *p_data = (char *) (p_msg + 1);
+        U32 data_len = p_msg->length - sizeof(RTX_MSG_HDR);
+
+        if (p_msg->type == DISPLAY) {
+            while (g_uart_tx_off < data_len && room > 0) {
+                UART0_PutTxData(p_data[g_uart_tx_off++]);
+                room--;
+            }
+            if (g_uart_tx_off < data_len) {
+                return;                 // FIFO full, wait for the next irq
+            }
+        }
+        g_uart_tx_off = 0;
+        k_mbx_pop(&g_uart_mbx, p_slot);
+        k_mbx_admit(&g_uart_mbx);
+    }
+    UART0_DisableTxIRQ();
 }
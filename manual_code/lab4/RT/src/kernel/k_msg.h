@@ -10,10 +10,23 @@
 
 #include "k_rtx.h"
 
+#define UART_MBX_SIZE   0x400   /* console output mailbox size in bytes */
+
 int k_mbx_create(size_t size);
+int k_mbx_create_prio(size_t size, U32 num_classes);
+int k_mbx_create_tid(task_t tid, size_t size, U32 num_classes);
+void k_mbx_free(task_t tid);
 int k_send_msg(task_t receiver_tid, const void *buf);
 int k_recv_msg(task_t *sender_tid, void *buf, size_t len);
 int k_recv_msg_nb(task_t *sender_tid, void *buf, size_t len);
+int k_send_msg_timed(task_t receiver_tid, const void *buf, TIMEVAL *tv);
+int k_recv_msg_timed(task_t *sender_tid, void *buf, size_t len, TIMEVAL *tv);
+int k_recv_msg_batch(task_t *sender_tids, void *buf, size_t len, int max_msgs);
 int k_mbx_ls(task_t *buf, int count);
+int k_mbx_get(task_t tid, RTX_MBX_INFO *buf);
+int k_mbx_send(task_t sender, task_t receiver_tid, const void *buf);
+int k_msg_init(void);
+BOOL k_msg_uart_rx(char c);
+void k_msg_uart_tx(void);
 
 #endif /* ! K_MSG_H_ */
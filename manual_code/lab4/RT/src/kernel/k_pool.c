@@ -0,0 +1,143 @@
+/*
+ ****************************************************************************
+ *
+ *                  UNIVERSITY OF WATERLOO ECE 350 RTOS LAB
+ *
+ *                     Copyright 2020-2021 Yiqing Huang
+ *                          All rights reserved.
+ *
+ *  Redistribution and use in source and binary forms, with or without
+ *  modification, are permitted provided that the following conditions are met:
+ *  - Redistributions of source code must retain the above copyright
+ *    notice and the following disclaimer.
+ *
+ *
+ *  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ *  AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ *  IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ *  ARE DISCLAIMED. IN NO EVENT SHALL COPYRIGHT HOLDERS AND CONTRIBUTORS BE
+ *  LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ *  CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ *  SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ *  INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ *  CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ *  ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ *  POSSIBILITY OF SUCH DAMAGE.
+ ****************************************************************************
+ */
+
+/**************************************************************************//**
+ * @file        k_pool.c
+ * @brief       Worker Pool C File
+ *
+ * @version     V1.2021.01
+ * @authors     Yiqing Huang
+ * @date        2021 JAN
+ *
+ * @details     pool_create starts the worker tasks once, pool_submit then
+ *              hands a job to them instead of creating a task for it.
+ *              Jobs wait in a ring, idle workers wait on g_pool_idle,
+ *              highest priority first and FIFO among equals, so a job
+ *              goes to the worker that has been idle the longest.
+ *              A woken worker may find the ring already drained by a
+ *              worker that finished its job first, it waits again.
+ *
+ *****************************************************************************/
+
+#include "k_pool.h"
+#include "k_task.h"
+
+/*
+ *===========================================================================
+ *                            GLOBAL VARIABLES
+ *===========================================================================
+ */
+
+static RTX_POOL_JOB g_pool_q[POOL_QUEUE_SIZE];
+static U32          g_pool_head;        // next job to take, free running
+static U32          g_pool_tail;        // next free slot, free running
+static TCB         *g_pool_idle;        // workers waiting for a job
+static U32          g_pool_workers;     // 0 until pool_create
+
+/*
+ *===========================================================================
+ *                            FUNCTIONS
+ *===========================================================================
+ */
+
+/**************************************************************************//**
+ * @brief       start the worker tasks of the pool, once
+ * @param       num_workers 1 to POOL_MAX_WORKERS
+ * @param       prio        worker priority, HIGH to LOWEST
+ * @param       stack_size  user stack of each worker, as for tsk_create
+ * @return      RTX_OK on success; RTX_ERR on failure
+ * @note        if a worker cannot be created the ones already started
+ *              stay in the pool and RTX_ERR is returned
+ *****************************************************************************/
+int k_pool_create(U32 num_workers, U8 prio, U16 stack_size)
+{
+    task_t tid;
+
+    if (g_pool_workers != 0 || num_workers == 0 || num_workers > POOL_MAX_WORKERS) {
+        return RTX_ERR;
+    }
+    g_pool_head = 0;
+    g_pool_tail = 0;
+    g_pool_idle = NULL;
+    for (U32 i = 0; i < num_workers; i++) {
+        if (k_tsk_create(&tid, pool_worker, prio, stack_size) != RTX_OK) {
+            return RTX_ERR;
+        }
+        g_pool_workers++;
+    }
+    return RTX_OK;
+}
+
+/**************************************************************************//**
+ * @brief       queue a job and wake an idle worker for it
+ * @param       fn      job entry, runs on a worker as fn(arg)
+ * @return      RTX_OK on success; RTX_ERR if there is no pool or
+ *              POOL_QUEUE_SIZE jobs are already waiting
+ * @note        never blocks. A worker of higher priority than the
+ *              caller runs the job before pool_submit returns
+ *****************************************************************************/
+int k_pool_submit(void (*fn)(void *arg), void *arg)
+{
+    RTX_POOL_JOB *p_job;
+
+    if (g_pool_workers == 0 || fn == NULL ||
+        g_pool_tail - g_pool_head == POOL_QUEUE_SIZE) {
+        return RTX_ERR;
+    }
+    p_job = &g_pool_q[g_pool_tail++ & (POOL_QUEUE_SIZE - 1)];
+    p_job->fn  = fn;
+    p_job->arg = arg;
+    if (g_pool_idle != NULL) {
+        k_tsk_wake(g_pool_idle, RTX_OK);
+    }
+    return RTX_OK;
+}
+
+/**************************************************************************//**
+ * @brief       the next job for a worker, waits while there is none
+ * @param[out]  job     the job is copied here
+ * @return      RTX_OK on success; RTX_ERR on failure
+ *****************************************************************************/
+int k_pool_take(RTX_POOL_JOB *job)
+{
+    if (job == NULL || g_pool_workers == 0) {
+        return RTX_ERR;
+    }
+    while (g_pool_head == g_pool_tail) {
+        // BLK_POOL, a message to the worker does not wake it up here
+        k_tsk_block(BLK_POOL, &g_pool_idle, NULL);
+    }
+    *job = g_pool_q[g_pool_head++ & (POOL_QUEUE_SIZE - 1)];
+    return RTX_OK;
+}
+
+/*
+ *===========================================================================
+ *                             END OF FILE
+ *===========================================================================
+ */
@@ -0,0 +1,158 @@
+/*
+ ****************************************************************************
+ *
+ *                  UNIVERSITY OF WATERLOO ECE 350 RTOS LAB
+ *
+ *                     Copyright 2020-2021 Yiqing Huang
+ *                          All rights reserved.
+ *
+ *  Redistribution and use in source and binary forms, with or without
+ *  modification, are permitted provided that the following conditions are met:
+ *  - Redistributions of source code must retain the above copyright
+ *    notice and the following disclaimer.
+ *
+ *
+ *  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ *  AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ *  IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ *  ARE DISCLAIMED. IN NO EVENT SHALL COPYRIGHT HOLDERS AND CONTRIBUTORS BE
+ *  LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ *  CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ *  SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ *  INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ *  CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ *  ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ *  POSSIBILITY OF SUCH DAMAGE.
+ ****************************************************************************
+ */
+
+/**************************************************************************//**
+ * @file        k_prof.c
+ * @brief       PC Sampling Profiler C File
+ *
+ * @version     V1.2021.01
+ * @authors     Yiqing Huang
+ * @date        2021 JAN
+ *
+ * @details     While profiling, HPS timer 1 runs at the requested rate and
+ *              its handler records the interrupted PC, processor mode and
+ *              running task into a ring. Tasks drain the ring with
+ *              prof_read; tools/prof.py turns the samples into a flat
+ *              profile and folded stacks.
+ *              The ring has one producer, the timer 1 handler, and one
+ *              consumer, k_prof_read, which runs with IRQs masked.
+ *
+ *****************************************************************************/
+
+#include "k_prof.h"
+#include "k_irq.h"
+
+/*
+ *===========================================================================
+ *                            GLOBAL VARIABLES
+ *===========================================================================
+ */
+
+static RTX_PROF_SAMPLE  g_prof_buf[PROF_BUF_SIZE];
+static volatile U32     g_prof_head;    // next sample to read
+static volatile U32     g_prof_tail;    // next sample to write
+static U32              g_prof_drops;   // samples lost to a full ring
+static BOOL             g_prof_on;
+
+/*
+ *===========================================================================
+ *                            FUNCTIONS
+ *===========================================================================
+ */
+
+/**************************************************************************//**
+ * @brief       start sampling
+ * @param       hz      samples per second, 1 to PROF_MAX_HZ
+ * @return      RTX_OK on success; RTX_ERR on failure
+ * @note        restarts with an empty ring. Needs HPS timer 1 on the IRQ
+ *              path, an FIQ handler never sees the interrupted frame
+ *****************************************************************************/
+int k_prof_start(U32 hz)
+{
+#ifdef RT_TIMER_FIQ
+    return RTX_ERR;
+#else
+    if (hz == 0 || hz > PROF_MAX_HZ) {
+        return RTX_ERR;
+    }
+    g_prof_head = 0;
+    g_prof_tail = 0;
+    g_prof_drops = 0;
+    g_prof_on = TRUE;
+    k_rt_timer_set(PROF_TIMER_CLK / hz);
+    return RTX_OK;
+#endif
+}
+
+/**************************************************************************//**
+ * @brief       stop sampling, HPS timer 1 goes back to the jitter probe
+ * @return      number of samples dropped because the ring was full
+ *****************************************************************************/
+int k_prof_stop(void)
+{
+    g_prof_on = FALSE;
+    k_rt_timer_set(RT_TIMER_COUNT);
+    return g_prof_drops;
+}
+
+/**************************************************************************//**
+ * @brief       record one sample
+ * @param       frame   exception frame of the interrupted context
+ * @note        called from the HPS timer 1 handler, a handful of loads and
+ *              stores; AE_LAT prof_overhead measures what sampling costs.
+ *              With RT_TIMER_FIQ the handler is reached through the FIQ
+ *              path, frame is then whatever IRQ was last interrupted and
+ *              no sample is taken
+ *****************************************************************************/
+void k_prof_sample(const U32 *frame)
+{
+    U32 tail = g_prof_tail;
+    RTX_PROF_SAMPLE *p_smp;
+
+#ifdef RT_TIMER_FIQ
+    frame = NULL;                       // stale, not the FIQ's own context
+#endif
+    if (!g_prof_on || frame == NULL) {
+        return;
+    }
+    if (tail - g_prof_head >= PROF_BUF_SIZE) {
+        g_prof_drops++;
+        return;
+    }
+    p_smp = &g_prof_buf[tail % PROF_BUF_SIZE];
+    p_smp->pc   = frame[IRQ_FRAME_PC];
+    p_smp->mode = (U8) (frame[IRQ_FRAME_SPSR] & 0x1F);
+    p_smp->tid  = (gp_current_task != NULL) ? gp_current_task->tid : TID_NULL;
+    g_prof_tail = tail + 1;
+}
+
+/**************************************************************************//**
+ * @brief       move samples out of the ring, oldest first
+ * @param[out]  buf     where the samples are copied to
+ * @param       max     room in buf, in samples
+ * @return      number of samples copied, RTX_ERR on failure
+ *****************************************************************************/
+int k_prof_read(RTX_PROF_SAMPLE *buf, int max)
+{
+    int n = 0;
+
+    if (buf == NULL || max <= 0) {
+        return RTX_ERR;
+    }
+    while (n < max && g_prof_head != g_prof_tail) {
+        buf[n++] = g_prof_buf[g_prof_head % PROF_BUF_SIZE];
+        g_prof_head++;
+    }
+    return n;
+}
+
+/*
+ *===========================================================================
+ *                             END OF FILE
+ *===========================================================================
+ */
@@ -43,22 +43,37 @@
 #include "Serial.h"
 #include "k_mem.h"
 #include "k_task.h"
+#include "k_msg.h"
+#include "k_work.h"
+#include "k_vfp.h"
 
 int k_rtx_init(RTX_TASK_INFO *task_info, int num_tasks)
 {
     // Initialize UART0 Rx interrupts
     UART0_Init();
-    // Set HPS0 timer to count down from
-    config_hps_timer(0,10000,1,0);
+    // Set HPS0 timer to count down from KERN_TICK_COUNT, one kernel tick
+    config_hps_timer(0,KERN_TICK_COUNT,1,0);
+    // Set HPS1 timer to a 1 ms period, its latency measures interrupt jitter
+    config_hps_timer(1,RT_TIMER_COUNT,1,0);
     // Set A9 timer to count down from 0xFFFFFFFF every 1 us
     // With this setting, A9 timer resets every ~1.2 hrs
     config_a9_timer(0xFFFFFFFF,1,0,199);
 
+    k_pmu_init();
+    k_vfp_init();
+    k_cache_init();
+
     /* interrupts are already disabled when we enter here */
+    k_work_init();
+
     if ( k_mem_init() != RTX_OK) {
         return RTX_ERR;
     }
 
+    if ( k_msg_init() != RTX_OK) {
+        return RTX_ERR;
+    }
+
     if ( k_tsk_init(task_info, num_tasks) != RTX_OK ) {
         return RTX_ERR;
     }
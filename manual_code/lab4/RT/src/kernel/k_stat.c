@@ -0,0 +1,139 @@
+/*
+ ****************************************************************************
+ *
+ *                  UNIVERSITY OF WATERLOO ECE 350 RTOS LAB
+ *
+ *                     Copyright 2020-2021 Yiqing Huang
+ *                          All rights reserved.
+ *
+ *  Redistribution and use in source and binary forms, with or without
+ *  modification, are permitted provided that the following conditions are met:
+ *  - Redistributions of source code must retain the above copyright
+ *    notice and the following disclaimer.
+ *
+ *
+ *  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ *  AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ *  IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ *  ARE DISCLAIMED. IN NO EVENT SHALL COPYRIGHT HOLDERS AND CONTRIBUTORS BE
+ *  LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ *  CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ *  SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ *  INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ *  CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ *  ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ *  POSSIBILITY OF SUCH DAMAGE.
+ ****************************************************************************
+ */
+
+/**************************************************************************//**
+ * @file        k_stat.c
+ * @brief       Kernel Statistics C File
+ *
+ * @version     V1.2021.01
+ * @authors     Yiqing Huang
+ * @date        2021 JAN
+ *
+ * @details     Collects task and mailbox statistics for console listings.
+ *              Counters and states are gathered in one IRQ-masked pass so
+ *              the caller gets a consistent picture; formatting is left to
+ *              the caller. The stack high-water marks are the ones the
+ *              null task caches, no stack is scanned here.
+ *
+ *****************************************************************************/
+
+#include "k_stat.h"
+#include "k_task.h"
+#include "k_msg.h"
+#include "timer.h"
+
+/*
+ *===========================================================================
+ *                            FUNCTIONS
+ *===========================================================================
+ */
+
+/**************************************************************************//**
+ * @brief       take a snapshot of all tasks and mailboxes
+ * @return      RTX_OK on success; RTX_ERR on failure
+ * @param[out]  buf     snapshot buffer the kernel writes to
+ * !!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!
+ * @attention   CRITICAL SECTION
+ *              everything is copied in one pass with IRQs disabled, keep
+ *              the per-entry work small
+ * !!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!
+ * @note        the stack high-water marks are as of the last idle scan,
+ *              see k_tsk_scan_idle
+ *****************************************************************************/
+int k_sys_snapshot(RTX_SNAPSHOT *buf)
+{
+    static task_t tids[MAX_TASKS];      // too big for the kernel stack
+    int           n;
+
+    if (buf == NULL) {
+        return RTX_ERR;
+    }
+
+    k_tsk_account(gp_current_task);     // bring the caller's run time up to date
+    buf->timestamp = timer_get_current_val(2);
+
+    buf->num_tasks = 0;
+    n = k_tsk_ls(tids, MAX_TASKS);
+    for ( int i = 0; i < n; i++ ) {
+        RTX_TASK_STAT *p_stat = &buf->tasks[buf->num_tasks];
+        TCB           *p_tcb  = &g_tcbs[tids[i]];
+
+        // straight from the TCB, k_tsk_get fills in much more
+        p_stat->tid          = p_tcb->tid;
+        p_stat->prio         = p_tcb->prio;
+        p_stat->state        = p_tcb->state;
+        p_stat->priv         = k_tcb_cold(p_tcb)->priv;
+        p_stat->run_time     = k_tcb_cold(p_tcb)->run_time;
+        p_stat->k_stack_used = k_tsk_stack_used(p_tcb);
+        p_stat->u_stack_used = k_tsk_ustack_used(p_tcb);
+        buf->num_tasks++;
+    }
+
+    buf->num_mbx = 0;
+    n = k_mbx_ls(tids, MAX_TASKS);
+    for ( int i = 0; i < n; i++ ) {
+        if (k_mbx_get(tids[i], &buf->mbx[buf->num_mbx]) == RTX_OK) {
+            buf->num_mbx++;
+        }
+    }
+    return RTX_OK;
+}
+
+/**************************************************************************//**
+ * @brief       hardware event totals of a task
+ * @return      RTX_OK on success; RTX_ERR on failure
+ * @param       tid     task to read, may be the caller
+ * @param[out]  buf     totals the kernel writes to
+ * @note        counts are charged at context switches and ticks, so a
+ *              task's totals include the interrupts taken while it ran
+ *****************************************************************************/
+int k_tsk_get_pmu(task_t tid, RTX_PMU_STAT *buf)
+{
+    TCB *p_tcb;
+
+    if (buf == NULL || tid >= MAX_TASKS) {
+        return RTX_ERR;
+    }
+    p_tcb = &g_tcbs[tid];
+    if (p_tcb->state == DORMANT) {
+        return RTX_ERR;
+    }
+
+    k_tsk_account(gp_current_task);     // bring the caller's counts up to date
+    buf->cycles      = k_tcb_cold(p_tcb)->pmu[PMU_CYCLES];
+    buf->insts       = k_tcb_cold(p_tcb)->pmu[PMU_INSTS];
+    buf->dcache_miss = k_tcb_cold(p_tcb)->pmu[PMU_DC_MISS];
+    buf->br_mispred  = k_tcb_cold(p_tcb)->pmu[PMU_BR_MISS];
+    return RTX_OK;
+}
+
+/*
+ *===========================================================================
+ *                             END OF FILE
+ *===========================================================================
+ */
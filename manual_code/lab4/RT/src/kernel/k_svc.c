@@ -0,0 +1,69 @@
+/*
+ ****************************************************************************
+ *
+ *                  UNIVERSITY OF WATERLOO ECE 350 RTOS LAB
+ *
+ *                     Copyright 2020-2021 Yiqing Huang
+ *                          All rights reserved.
+ *
+ *  Redistribution and use in source and binary forms, with or without
+ *  modification, are permitted provided that the following conditions are met:
+ *  - Redistributions of source code must retain the above copyright
+ *    notice and the following disclaimer.
+ *
+ *
+ *  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ *  AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ *  IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ *  ARE DISCLAIMED. IN NO EVENT SHALL COPYRIGHT HOLDERS AND CONTRIBUTORS BE
+ *  LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ *  CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ *  SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ *  INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ *  CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ *  ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ *  POSSIBILITY OF SUCH DAMAGE.
+ ****************************************************************************
+ */
+
+/**************************************************************************//**
+ * @file        k_svc.c
+ * @brief       System call dispatch table
+ *
+ * @version     V1.2021.01
+ * @authors     Yiqing Huang
+ * @date        2021 JAN
+ *
+ * @details     SVC_Handler indexes g_svc_table with the SVC number and
+ *              calls the entry with the caller's R0-R3. The entries are
+ *              made from rtx_svc.h in the order rtx.h numbers them.
+ *
+ *****************************************************************************/
+
+#include "k_inc.h"
+#include "rtx.h"
+
+/*
+ *==========================================================================
+ *                            GLOBAL VARIABLES
+ *==========================================================================
+ */
+
+void (* const g_svc_table[SVC_NUM])(void) = {
+#define RTX_SVC_LEAF(name, ret, params, args)   (void (*)(void)) k_##name,
+#define RTX_SVC(name, ret, params, args)
+#include "rtx_svc.h"
+#undef  RTX_SVC_LEAF
+#undef  RTX_SVC
+#define RTX_SVC_LEAF(name, ret, params, args)
+#define RTX_SVC(name, ret, params, args)        (void (*)(void)) k_##name,
+#include "rtx_svc.h"
+#undef  RTX_SVC_LEAF
+#undef  RTX_SVC
+};
+
+/*
+ *===========================================================================
+ *                             END OF FILE
+ *===========================================================================
+ */
@@ -52,6 +52,7 @@
 #include "Serial.h"
 #include "k_task.h"
 #include "k_rtx.h"
+#include "k_vfp.h"
 
 #ifdef DEBUG_0
 #include "printf.h"
@@ -63,10 +64,35 @@
  *==========================================================================
  */
 
-TCB             *gp_current_task = NULL;	// the current RUNNING task
-TCB             g_tcbs[MAX_TASKS];			// an array of TCBs
+TCB             *gp_current_task K_HOT_DATA = NULL;	// the current RUNNING task
+TCB             g_tcbs[MAX_TASKS] K_HOT_DATA;		// an array of TCBs
+TCB_COLD        g_tcb_cold[MAX_TASKS];      // the rest of each task, by tid
 RTX_TASK_INFO   g_null_task_info;			// The null task info
 U32             g_num_active_tasks = 0;		// number of non-dormant tasks
+U32             g_need_resched K_HOT_DATA = RESCHED_NONE;  // pending switch, see k_tsk_resched
+static U32      g_switch_ts = 0xFFFFFFFF;   // A9 timer value at the last context switch
+static U32      g_switch_pmu[PMU_NUM_CNT];  // PMU counts at the last context switch
+static TCB     *g_rdy_head[NUM_PRIO_LEVELS] K_HOT_DATA;    // ready queues, one FIFO per priority level
+static TCB     *g_rdy_tail[NUM_PRIO_LEVELS] K_HOT_DATA;
+static U32      g_rdy_map K_HOT_DATA;       // bit (31 - level) set if that level is non-empty
+static TCB     *g_timer_q;                  // tasks waiting on a timeout, delta encoded
+static U32      g_ticks;                    // kernel ticks since boot, RT releases count in it
+static U32      g_slice_ticks;              // ticks the running task has had since it was switched in
+static TCB     *g_active_head;              // non-dormant tasks, linked through TCB_COLD
+static task_t   g_free_tid[MAX_TASKS];      // free tids, the last one freed on top
+static U32      g_num_free_tid;
+#ifdef KERN_SRP
+/*
+ * Not full SRP: all RT tasks are one preemption level with one shared stack,
+ * so the ceiling is always that level and g_srp_owner is the whole of it.
+ * A job that blocked while holding the stack would hold back every other RT
+ * release for as long as it waits, an unbounded inversion, so k_tsk_block
+ * refuses the owner. Per-level stacks and ceilings would lift that.
+ */
+static U32      g_srp_stack_hi;             // the user stack shared by all RT jobs
+static TCB     *g_srp_owner;                // RT job running on it, NULL if it is free
+static TCB     *g_srp_pend;                 // released RT jobs waiting for it, FIFO
+#endif
 
 /*---------------------------------------------------------------------------
 The memory map of the OS image may look like the following:
@@ -82,18 +108,6 @@ The memory map of the OS image may look like the following:
                               |                           |
  &Image$$ZI_DATA$$ZI$$Limit-->|---------------------------|-----+-----
                               |         ......            |     ^
-                              |---------------------------|     |
-                              |      PROC_STACK_SIZE      |     |
-             g_p_stacks[15]-->|---------------------------|     |
-                              |                           |     |
-                              |  other kernel proc stacks |     |
-                              |---------------------------|     |
-                              |      PROC_STACK_SIZE      |  OS Image
-              g_p_stacks[2]-->|---------------------------|     |
-                              |      PROC_STACK_SIZE      |     |
-              g_p_stacks[1]-->|---------------------------|     |
-                              |      PROC_STACK_SIZE      |     |
-              g_p_stacks[0]-->|---------------------------|     |
                               |   other  global vars      |     |
                               |                           |  OS Image
                               |---------------------------|     |
@@ -128,75 +142,257 @@ The memory map of the OS image may look like the following:
  *===========================================================================
  */
 
+/**************************************************************************//**
+ * @brief   map a task priority to its ready queue, 0 is the most urgent
+ *****************************************************************************/
+K_HOT static U32 k_prio_level(U8 prio)
+{
+    if ( prio == PRIO_RT ) {
+        return 0;
+    }
+    if ( prio == PRIO_NULL ) {
+        return NUM_PRIO_LEVELS - 1;
+    }
+    return prio - HIGH + 1;
+}
+
+/**************************************************************************//**
+ * @brief   put a READY task on the ready queue of its priority
+ * @param   front   TRUE to run it before tasks of the same priority
+ *                  (a preempted task keeps its turn), FALSE to queue it last
+ *****************************************************************************/
+K_HOT static void k_rdy_push(TCB *p_tcb, BOOL front)
+{
+    U32 lvl = k_prio_level(p_tcb->prio);
+
+    if ( g_rdy_head[lvl] == NULL ) {
+        p_tcb->next = NULL;
+        g_rdy_head[lvl] = p_tcb;
+        g_rdy_tail[lvl] = p_tcb;
+        g_rdy_map |= 0x80000000U >> lvl;
+    } else if ( front ) {
+        p_tcb->next = g_rdy_head[lvl];
+        g_rdy_head[lvl] = p_tcb;
+    } else {
+        p_tcb->next = NULL;
+        g_rdy_tail[lvl]->next = p_tcb;
+        g_rdy_tail[lvl] = p_tcb;
+    }
+}
+
 /**************************************************************************//**
  * @brief   scheduler, pick the TCB of the next to run task
  *
- * @return  TCB pointer of the next to run task
- * @post    gp_curret_task is updated
+ * @return  TCB pointer of the next to run task, removed from its ready queue
+ * @pre     a caller that wants to keep running is already on a ready queue
+ * @note    O(1): the highest non-empty level is found with one CLZ
  *
  *****************************************************************************/
 
-TCB *scheduler(void)
+K_HOT TCB *scheduler(void)
 {
-    task_t tid = gp_current_task->tid;
-    return &g_tcbs[(++tid)%g_num_active_tasks];
+    U32 lvl;
+    TCB *p_tcb;
 
+    if ( g_rdy_map == 0 ) {
+        return NULL;
+    }
+
+    lvl = __clz(g_rdy_map);
+    p_tcb = g_rdy_head[lvl];
+    g_rdy_head[lvl] = p_tcb->next;
+    if ( g_rdy_head[lvl] == NULL ) {
+        g_rdy_tail[lvl] = NULL;
+        g_rdy_map &= ~(0x80000000U >> lvl);
+    }
+    p_tcb->next = NULL;
+    return p_tcb;
 }
 
+/**************************************************************************//**
+ * @brief   insert a task into a wait queue, highest priority first,
+ *          FIFO among equal priorities
+ *****************************************************************************/
+static void k_wait_insert(TCB **wait_q, TCB *p_tcb)
+{
+    TCB **pp = wait_q;
 
+    while ( *pp != NULL && (*pp)->prio <= p_tcb->prio ) {
+        pp = &(*pp)->next;
+    }
+    p_tcb->next = *pp;
+    *pp = p_tcb;
+    p_tcb->wait_q = wait_q;
+}
+
+static void k_wait_remove(TCB *p_tcb)
+{
+    TCB **pp = p_tcb->wait_q;
+
+    while ( *pp != p_tcb ) {
+        pp = &(*pp)->next;
+    }
+    *pp = p_tcb->next;
+    p_tcb->next = NULL;
+    p_tcb->wait_q = NULL;
+}
 
 /**************************************************************************//**
- * @brief       initialize all boot-time tasks in the system,
- *
- *
- * @return      RTX_OK on success; RTX_ERR on failure
- * @param       task_info   boot-time task information structure pointer
- * @param       num_tasks   boot-time number of tasks
- * @pre         memory has been properly initialized
- * @post        none
- *
- * @see         k_tsk_create_new
+ * @brief   arm a timeout, the timer queue keeps each entry's ticks relative
+ *          to the entry before it so that a tick only touches the head
  *****************************************************************************/
+static void k_timer_add(TCB *p_tcb, U32 ticks)
+{
+    TCB **pp = &g_timer_q;
 
-int k_tsk_init(RTX_TASK_INFO *task_info, int num_tasks)
+    while ( *pp != NULL && (*pp)->tdelta <= ticks ) {
+        ticks -= (*pp)->tdelta;
+        pp = &(*pp)->tnext;
+    }
+    if ( *pp != NULL ) {
+        (*pp)->tdelta -= ticks;
+    }
+    p_tcb->tdelta = ticks;
+    p_tcb->tnext = *pp;
+    p_tcb->timed = 1;
+    *pp = p_tcb;
+}
+
+static void k_timer_cancel(TCB *p_tcb)
 {
-    extern U32 SVC_RESTORE;
+    TCB **pp = &g_timer_q;
 
-    RTX_TASK_INFO *p_taskinfo = &g_null_task_info;
-    g_num_active_tasks = 0;
+    while ( *pp != p_tcb ) {
+        pp = &(*pp)->tnext;
+    }
+    *pp = p_tcb->tnext;
+    if ( *pp != NULL ) {
+        (*pp)->tdelta += p_tcb->tdelta;
+    }
+    p_tcb->tnext = NULL;
+    p_tcb->timed = 0;
+}
 
-    if (num_tasks > MAX_TASKS) {
-    	return RTX_ERR;
+/**************************************************************************//**
+ * @brief   convert a timeout to kernel ticks, rounding up
+ *****************************************************************************/
+static U32 k_tv_to_ticks(const TIMEVAL *tv)
+{
+    return tv->sec * (1000000U / KERN_TICK_USEC) +
+           (tv->usec + KERN_TICK_USEC - 1) / KERN_TICK_USEC;
+}
+
+/**************************************************************************//**
+ * @brief       make a blocked task eligible to run again
+ * @param       p_tcb   the task to wake up
+ * @note        cancels its timeout and takes it off any wait queue.
+ *              Does not reschedule, the caller decides when to switch
+ *****************************************************************************/
+K_HOT void k_tsk_ready(TCB *p_tcb)
+{
+    if ( p_tcb->state != BLK_MSG && p_tcb->state != BLK_SEND &&
+         p_tcb->state != BLK_POOL && p_tcb->state != SUSPENDED ) {
+        return;
+    }
+    if ( p_tcb->timed ) {
+        k_timer_cancel(p_tcb);
+    }
+    if ( p_tcb->wait_q != NULL ) {
+        k_wait_remove(p_tcb);
     }
+    p_tcb->state = READY;
+    k_rdy_push(p_tcb, FALSE);
+}
 
-    // create the first task
-    TCB *p_tcb = &g_tcbs[0];
-    p_tcb->prio     = PRIO_NULL;
-    p_tcb->priv     = 1;
-    p_tcb->tid      = TID_NULL;
-    p_tcb->state    = RUNNING;
-    g_num_active_tasks++;
-    gp_current_task = p_tcb;
+/**************************************************************************//**
+ * @brief       end the blocking wait of a task
+ * @param       rc      value k_tsk_block returns to the woken task
+ * @return      TRUE if the woken task should preempt the running one
+ * @note        does not switch, a higher priority wakeup only raises
+ *              g_need_resched for the way out of the kernel
+ *****************************************************************************/
+K_HOT BOOL k_tsk_wake(TCB *p_tcb, int rc)
+{
+    p_tcb->wait_rc = rc;
+    k_tsk_ready(p_tcb);
+    if ( p_tcb->prio < gp_current_task->prio ) {
+        k_tsk_need_resched(RESCHED_PREEMPT);
+        return TRUE;
+    }
+    return FALSE;
+}
 
-    // create the rest of the tasks
-    p_taskinfo = task_info;
-    for ( int i = 0; i < num_tasks; i++ ) {
-        TCB *p_tcb = &g_tcbs[i+1];
-        if (k_tsk_create_new(p_taskinfo, p_tcb, i+1) == RTX_OK) {
-        	g_num_active_tasks++;
-        }
-        p_taskinfo++;
+/**************************************************************************//**
+ * @brief       ask for a switch on the way out of the kernel
+ * @param       how     RESCHED_PREEMPT or RESCHED_YIELD
+ * @note        requests only strengthen until k_tsk_resched consumes them
+ *****************************************************************************/
+K_HOT void k_tsk_need_resched(U32 how)
+{
+    if ( how > g_need_resched ) {
+        g_need_resched = how;
+    }
+}
+
+/**************************************************************************//**
+ * @brief       carry out the pending g_need_resched request
+ * @return      RTX_OK upon success
+ *              RTX_ERR upon failure
+ * @note        called once at the outermost SVC or IRQ exit, IRQs masked,
+ *              on the kernel stack of the task that entered the kernel
+ *****************************************************************************/
+K_HOT int k_tsk_resched(void)
+{
+    U32 how = g_need_resched;
+
+    g_need_resched = RESCHED_NONE;
+    if ( how == RESCHED_YIELD ) {
+        return k_tsk_run_new();
+    }
+    if ( how == RESCHED_PREEMPT ) {
+        return k_tsk_preempt();
     }
     return RTX_OK;
 }
+
 /**************************************************************************//**
- * @brief       initialize a new task in the system,
- *              one dummy kernel stack frame, one dummy user stack frame
- *
- * @return      RTX_OK on success; RTX_ERR on failure
- * @param       p_taskinfo  task information structure pointer
- * @param       p_tcb       the tcb the task is assigned to
- * @param       tid         the tid the task is assigned to
+ * @brief       block the running task until k_tsk_wake or a timeout
+ * @param       state   BLK_MSG, BLK_SEND, BLK_POOL or SUSPENDED
+ * @param       wait_q  priority ordered queue to wait on, NULL if none
+ * @param       tv      timeout, NULL to wait forever
+ * @return      the rc passed to k_tsk_wake, RTX_ERR on timeout
+ * @note        with KERN_SRP an RT job running on the shared stack may not
+ *              block, RTX_ERR right away; it has to finish with tsk_done_rt
+ *****************************************************************************/
+int k_tsk_block(U8 state, TCB **wait_q, const TIMEVAL *tv)
+{
+    TCB *p_tcb = gp_current_task;
+
+#ifdef KERN_SRP
+    if ( g_srp_owner == p_tcb ) {
+        return RTX_ERR;
+    }
+#endif
+    p_tcb->state = state;
+    p_tcb->wait_rc = RTX_ERR;
+    if ( wait_q != NULL ) {
+        k_wait_insert(wait_q, p_tcb);
+    }
+    if ( tv != NULL ) {
+        U32 ticks = k_tv_to_ticks(tv);
+        k_timer_add(p_tcb, (ticks == 0) ? 1 : ticks);
+    }
+    k_tsk_run_new();
+    return p_tcb->wait_rc;
+}
+
+/**************************************************************************//**
+ * @brief       fabricate the initial frames of a task below sp
+ * @return      the msp of the task
+ * @param       sp      kernel stack base (high addr.)
+ * @param       priv    = 0 for a task that starts in user mode
+ * @param       entry   entry point of the task
+ * @param       u_sp    initial user stack pointer, unused if priv
  *
  * @details     From bottom of the stack,
  *              we have user initial context (xPSR, PC, SP_USR, uR0-uR12)
@@ -206,28 +402,9 @@ int k_tsk_init(RTX_TASK_INFO *task_info, int num_tasks)
  *              30 registers in total
  *
  *****************************************************************************/
-int k_tsk_create_new(RTX_TASK_INFO *p_taskinfo, TCB *p_tcb, task_t tid)
+static U32 *k_tsk_frame(U32 *sp, U8 priv, void (*entry)(), U32 u_sp)
 {
     extern U32 SVC_RESTORE;
-    extern U32 K_RESTORE;
-
-    U32 *sp;
-
-    if (p_taskinfo == NULL || p_tcb == NULL)
-    {
-        return RTX_ERR;
-    }
-
-    p_tcb ->tid = tid;
-    p_tcb->state = READY;
-
-    /*---------------------------------------------------------------
-     *  Step1: allocate kernel stack for the task
-     *         stacks grows down, stack base is at the high address
-     * -------------------------------------------------------------*/
-
-    ///////sp = g_k_stacks[tid] + (KERN_STACK_SIZE >> 2) ;
-    sp = k_alloc_k_stack(tid);
 
     // 8B stack alignment adjustment
     if ((U32)sp & 0x04) {   // if sp not 8B aligned, then it must be 4B aligned
@@ -249,16 +426,12 @@ int k_tsk_create_new(RTX_TASK_INFO *p_taskinfo, TCB *p_tcb, task_t tid)
     // if kernel task runs under SVC mode, then no need to create user context stack frame for SVC handler entering
     // since we never enter from SVC handler in this case
     // uSP: initial user stack
-    if ( p_taskinfo->priv == 0 ) { // unprivileged task
+    if ( priv == 0 ) { // unprivileged task
         // xPSR: Initial Processor State
         *(--sp) = INIT_CPSR_USER;
         // PC contains the entry point of the user/privileged task
-        *(--sp) = (U32) (p_taskinfo->ptask);
-
-        //********************************************************************//
-        //*** allocate user stack from the user space, not implemented yet ***//
-        //********************************************************************//
-        *(--sp) = (U32) k_alloc_p_stack(tid);
+        *(--sp) = (U32) entry;
+        *(--sp) = u_sp;
 
         // uR12, uR11, ..., uR0
         for ( int j = 0; j < 13; j++ ) {
@@ -273,12 +446,12 @@ int k_tsk_create_new(RTX_TASK_INFO *p_taskinfo, TCB *p_tcb, task_t tid)
      *         14 registers listed in push order
      *         <kLR, kR0-kR12>
      * -------------------------------------------------------------*/
-    if ( p_taskinfo->priv == 0 ) {
+    if ( priv == 0 ) {
         // user thread LR: return to the SVC handler
         *(--sp) = (U32) (&SVC_RESTORE);
     } else {
         // kernel thread LR: return to the entry point of the task
-        *(--sp) = (U32) (p_taskinfo->ptask);
+        *(--sp) = (U32) entry;
     }
 
     // kernel stack R0 - R12, 13 registers
@@ -286,39 +459,510 @@ int k_tsk_create_new(RTX_TASK_INFO *p_taskinfo, TCB *p_tcb, task_t tid)
         *(--sp) = 0x0;
     }
 
-    p_tcb->msp = sp;
+    return sp;
+}
+
+#ifdef KERN_SRP
+/**************************************************************************//**
+ * @brief       give the shared RT stack to a job, which starts on it afresh
+ * @note        the job is not running, the context it left in
+ *              k_tsk_done_rt is dropped along with its kernel frames
+ *****************************************************************************/
+static void k_srp_start(TCB *p_tcb)
+{
+    TCB_COLD *p_cold = k_tcb_cold(p_tcb);
+
+    g_srp_owner = p_tcb;
+    k_vfp_reset(p_tcb);
+    p_tcb->msp = k_tsk_frame((U32 *) p_cold->k_stack_hi, 0, p_cold->ptask, g_srp_stack_hi);
+}
+
+/**************************************************************************//**
+ * @brief       the owner is done with the shared RT stack, the oldest
+ *              waiting job starts on it
+ *****************************************************************************/
+static void k_srp_release(void)
+{
+    g_srp_owner = NULL;
+    if ( g_srp_pend != NULL ) {
+        TCB *p_next = g_srp_pend;
+
+        g_srp_pend = p_next->next;
+        k_srp_start(p_next);
+        k_tsk_wake(p_next, RTX_OK);
+    }
+}
+#endif
+
+/**************************************************************************//**
+ * @brief       release the next job of an RT task
+ * @return      TRUE if it should preempt the running task
+ * @note        with KERN_SRP a job only starts while the shared stack is
+ *              free: all RT tasks have the one preemption level, so the
+ *              ceiling is reached as soon as any RT job holds the stack.
+ *              Otherwise it waits SUSPENDED on g_srp_pend
+ *****************************************************************************/
+static BOOL k_tsk_rt_release(TCB *p_tcb)
+{
+    k_tcb_cold(p_tcb)->rt_idle = 0;
+#ifdef KERN_SRP
+    if ( g_srp_owner != NULL ) {
+        TCB **pp = &g_srp_pend;
 
+        while ( *pp != NULL ) {
+            pp = &(*pp)->next;
+        }
+        p_tcb->next = NULL;
+        *pp = p_tcb;
+        return FALSE;
+    }
+    k_srp_start(p_tcb);
+#endif
+    return k_tsk_wake(p_tcb, RTX_OK);
+}
+
+/**************************************************************************//**
+ * @brief       TRUE if a task of the same priority waits on the ready queue
+ * @note        RT jobs run to completion and the null task has no peers,
+ *              neither is time sliced
+ *****************************************************************************/
+static BOOL k_tsk_peer_ready(const TCB *p_tcb)
+{
+    if ( p_tcb->state != RUNNING || p_tcb->prio == PRIO_RT ||
+         p_tcb->prio == PRIO_NULL ) {
+        return FALSE;
+    }
+    return ( g_rdy_head[k_prio_level(p_tcb->prio)] != NULL );
+}
+
+/**************************************************************************//**
+ * @brief       advance the timer queue by one kernel tick
+ * @return      TRUE if a task that should preempt the running one timed out
+ * @note        called from the HPS timer 0 interrupt handler. Every
+ *              KERN_SLICE_TICKS the running task also yields to a READY
+ *              peer of its own priority, on the way out of the kernel
+ *****************************************************************************/
+BOOL k_tsk_tick(void)
+{
+    BOOL resched = FALSE;
+
+    g_ticks++;
+    if ( ++g_slice_ticks >= KERN_SLICE_TICKS ) {
+        g_slice_ticks = 0;
+        if ( k_tsk_peer_ready(gp_current_task) ) {
+            k_tsk_need_resched(RESCHED_YIELD);
+        }
+    }
+    if ( g_timer_q == NULL ) {
+        return FALSE;
+    }
+    g_timer_q->tdelta--;
+    while ( g_timer_q != NULL && g_timer_q->tdelta == 0 ) {
+        TCB *p_tcb = g_timer_q;
+
+        g_timer_q = p_tcb->tnext;
+        p_tcb->tnext = NULL;
+        p_tcb->timed = 0;
+        if ( k_tcb_cold(p_tcb)->rt_idle ) {
+            resched |= k_tsk_rt_release(p_tcb);
+        } else if ( k_tsk_wake(p_tcb, RTX_ERR) ) {
+            resched = TRUE;
+        }
+    }
+    return resched;
+}
+
+/**************************************************************************//**
+ * @brief       time since the kernel started, to the kernel tick
+ * @return      RTX_OK on success, RTX_ERR if tv is NULL
+ *****************************************************************************/
+int k_get_time(TIMEVAL *tv)
+{
+    U32 ticks = g_ticks;
+
+    if ( tv == NULL ) {
+        return RTX_ERR;
+    }
+    tv->sec  = ticks / (1000000U / KERN_TICK_USEC);
+    tv->usec = (ticks % (1000000U / KERN_TICK_USEC)) * KERN_TICK_USEC;
     return RTX_OK;
 }
 
 /**************************************************************************//**
- * @brief       switching kernel stacks of two TCBs
- * @param:      p_tcb_old, the old tcb that was in RUNNING
- * @return:     RTX_OK upon success
- *              RTX_ERR upon failure
- * @pre:        gp_current_task is pointing to a valid TCB
- *              gp_current_task->state = RUNNING
- *              gp_crrent_task != p_tcb_old
- *              p_tcb_old == NULL or p_tcb_old->state updated
- * @note:       caller must ensure the pre-conditions are met before calling.
- *              the function does not check the pre-condition!
- * !!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!
- * @attention   CRITICAL SECTION
- * !!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!
+ * @brief       charge the time and PMU events since the last context switch
+ *              to the given task
+ * @param       p_tcb   the task that has been running since the last switch
+ * @note        the A9 private timer counts down once every microsecond.
+ *              The PMU counters are 32 bits wide, the tick charges the
+ *              running task too so that a delta never wraps
+ *****************************************************************************/
+K_HOT void k_tsk_account(TCB *p_tcb)
+{
+    TCB_COLD *p_cold = k_tcb_cold(p_tcb);
+    U32 now = timer_get_current_val(2);
+    U32 pmu[PMU_NUM_CNT];
+
+    p_cold->run_time += g_switch_ts - now;
+    g_switch_ts = now;
+
+    k_pmu_read(pmu);
+    for ( int i = 0; i < PMU_NUM_CNT; i++ ) {
+        p_cold->pmu[i] += pmu[i] - g_switch_pmu[i];
+        g_switch_pmu[i] = pmu[i];
+    }
+}
+
+/**************************************************************************//**
+ * @brief       fill the low end of a stack with STACK_PAINT
+ * @param       hi      stack base (high addr.)
+ * @param       size    stack size in bytes
+ * @param       live    lowest address in use, the paint stops below it
+ *****************************************************************************/
+static void k_stack_paint(U32 hi, U32 size, U32 live)
+{
+    U32 *p   = (U32 *) (hi - size);
+    U32 *end = (U32 *) (hi - size + ((size < STACK_PAINT_MAX) ? size : STACK_PAINT_MAX));
+
+    if ( live > (U32) p && live < (U32) end ) {
+        end = (U32 *) (live & ~3U);
+    }
+    while ( p < end ) {
+        *p++ = STACK_PAINT;
+    }
+}
+
+/**************************************************************************//**
+ * @brief       scan a painted stack from its low end for the deepest use
+ * @return      bytes between the stack base and the deepest overwritten
+ *              word; size - STACK_PAINT_MAX if the painted part is intact,
+ *              the use is at most that much
+ *****************************************************************************/
+static U32 k_stack_scan(U32 hi, U32 size)
+{
+    U32 *p   = (U32 *) (hi - size);
+    U32 *end = (U32 *) (hi - size + ((size < STACK_PAINT_MAX) ? size : STACK_PAINT_MAX));
+
+    while ( p < end && *p == STACK_PAINT ) {
+        p++;
+    }
+    return hi - (U32) p;
+}
+
+/**************************************************************************//**
+ * @brief       kernel stack high-water mark of a task
+ * @return      number of bytes used at the deepest point, as of the last
+ *              k_tsk_scan_idle pass over the task; 0 before the first one
+ *****************************************************************************/
+U32 k_tsk_stack_used(TCB *p_tcb)
+{
+    return k_tcb_cold(p_tcb)->k_stack_used;
+}
+
+/**************************************************************************//**
+ * @brief       user stack high-water mark of a task, 0 if it has none
+ * @see         k_tsk_stack_used
+ *****************************************************************************/
+U32 k_tsk_ustack_used(TCB *p_tcb)
+{
+    return k_tcb_cold(p_tcb)->u_stack_used;
+}
+
+/**************************************************************************//**
+ * @brief       rescan the painted stacks of the next task in tid order and
+ *              cache its high-water marks, for the null task to call
+ * @pre         IRQs masked; they are enabled for the scan itself
+ * @note        one task per call keeps each idle wakeup short. The marks
+ *              only move while the system idles now and then. A task that
+ *              exits, or whose tid is taken again, during the scan bumps
+ *              stk_gen and the stale result is dropped
+ *****************************************************************************/
+void k_tsk_scan_idle(void)
+{
+    static task_t tid = TID_NULL;
+    TCB      *p_tcb;
+    TCB_COLD *p_cold;
+    U32 gen, k_hi, k_size, u_hi, u_size, k_used, u_used;
+
+    tid = (tid + 1) % MAX_TASKS;
+    p_tcb  = &g_tcbs[tid];
+    p_cold = &g_tcb_cold[tid];
+    if ( p_tcb->state == DORMANT ) {
+        return;
+    }
+    gen    = p_cold->stk_gen;
+    k_hi   = p_cold->k_stack_hi;
+    k_size = p_cold->k_stack_size;
+    u_hi   = p_cold->u_stack_hi;
+    u_size = p_cold->u_stack_size;
+
+    __enable_irq();
+    k_used = k_stack_scan(k_hi, k_size);
+    u_used = k_stack_scan(u_hi, u_size);
+    __disable_irq();
+
+    if ( p_cold->stk_gen == gen ) {
+        p_cold->k_stack_used = k_used;
+        p_cold->u_stack_used = u_used;
+    }
+}
+
+/**************************************************************************//**
+ * @brief   TRUE if the task has a user stack of its own on the heap,
+ *          FALSE for privileged tasks and RT jobs on the shared SRP stack
+ *****************************************************************************/
+static BOOL k_tsk_own_ustack(const TCB_COLD *p_cold)
+{
+#ifdef KERN_SRP
+    if ( p_cold->u_stack_hi == g_srp_stack_hi ) {
+        return FALSE;
+    }
+#endif
+    return ( p_cold->u_stack_hi != 0 );
+}
+
+/**************************************************************************//**
+ * @brief   give the user stack of a task back to the heap
+ *****************************************************************************/
+static void k_tsk_free_ustack(TCB_COLD *p_cold)
+{
+    if ( k_tsk_own_ustack(p_cold) ) {
+        k_free_p_stack((U32 *) p_cold->u_stack_hi, p_cold->u_stack_size);
+    }
+    p_cold->u_stack_hi   = 0;
+    p_cold->u_stack_size = 0;
+}
+
+
+/**************************************************************************//**
+ * @brief   take a free tid, the one freed last so its stacks and TCB
+ *          are likely still in the cache
+ * @return  TID_NULL if all tids are in use
+ *****************************************************************************/
+static task_t k_tid_alloc(void)
+{
+    if ( g_num_free_tid == 0 ) {
+        return TID_NULL;
+    }
+    return g_free_tid[--g_num_free_tid];
+}
+
+static void k_tid_free(task_t tid)
+{
+    g_free_tid[g_num_free_tid++] = tid;
+}
+
+/**************************************************************************//**
+ * @brief   put a new task on the active list, tsk_ls walks it instead of
+ *          all MAX_TASKS TCBs
+ *****************************************************************************/
+static void k_active_add(TCB *p_tcb)
+{
+    TCB_COLD *p_cold = k_tcb_cold(p_tcb);
+
+    p_cold->a_prev = NULL;
+    p_cold->a_next = g_active_head;
+    if ( g_active_head != NULL ) {
+        k_tcb_cold(g_active_head)->a_prev = p_tcb;
+    }
+    g_active_head = p_tcb;
+    g_num_active_tasks++;
+}
+
+static void k_active_remove(TCB *p_tcb)
+{
+    TCB_COLD *p_cold = k_tcb_cold(p_tcb);
+
+    if ( p_cold->a_prev != NULL ) {
+        k_tcb_cold(p_cold->a_prev)->a_next = p_cold->a_next;
+    } else {
+        g_active_head = p_cold->a_next;
+    }
+    if ( p_cold->a_next != NULL ) {
+        k_tcb_cold(p_cold->a_next)->a_prev = p_cold->a_prev;
+    }
+    p_cold->a_prev = NULL;
+    p_cold->a_next = NULL;
+    g_num_active_tasks--;
+}
+
+/**************************************************************************//**
+ * @brief       initialize all boot-time tasks in the system,
+ *
+ *
+ * @return      RTX_OK on success; RTX_ERR on failure
+ * @param       task_info   boot-time task information structure pointer
+ * @param       num_tasks   boot-time number of tasks
+ * @pre         memory has been properly initialized
+ * @post        none
  *
+ * @see         k_tsk_create_new
  *****************************************************************************/
-__asm void k_tsk_switch(TCB *p_tcb_old)
+
+int k_tsk_init(RTX_TASK_INFO *task_info, int num_tasks)
 {
-        PUSH    {R0-R12, LR}
-        STR     SP, [R0, #TCB_MSP_OFFSET]   ; save SP to p_old_tcb->msp
-K_RESTORE
-        LDR     R1, =__cpp(&gp_current_task);
-        LDR     R2, [R1]
-        LDR     SP, [R2, #TCB_MSP_OFFSET]   ; restore msp of the gp_current_task
+    extern U32 SVC_RESTORE;
+
+    RTX_TASK_INFO *p_taskinfo = &g_null_task_info;
+    RTX_TASK_INFO  kcd_info;
+    g_num_active_tasks = 0;
+    g_active_head = NULL;
+
+    // the null task and the KCD task take two of the slots
+    if (num_tasks > MAX_TASKS - 2) {
+    	return RTX_ERR;
+    }
+
+    // create the first task
+    TCB *p_tcb = &g_tcbs[0];
+    TCB_COLD *p_cold = &g_tcb_cold[0];
+    p_tcb->prio     = PRIO_NULL;
+    p_tcb->tid      = TID_NULL;
+    p_tcb->state    = RUNNING;
+    p_cold->priv    = 1;
+    p_cold->ptask   = &task_null;
+    p_cold->k_stack_hi   = (U32) k_alloc_k_stack(TID_NULL);
+    p_cold->k_stack_size = KERN_STACK_SIZE;
+    // the boot code runs on this stack, leave what it uses alone
+    k_stack_paint(p_cold->k_stack_hi, KERN_STACK_SIZE, __current_sp() - 0x40);
+    k_active_add(p_tcb);
+    gp_current_task = p_tcb;
+    g_switch_ts = timer_get_current_val(2);
+#ifdef KERN_SRP
+    g_srp_stack_hi = (U32) k_alloc_srp_stack();
+    g_srp_owner    = NULL;
+    g_srp_pend     = NULL;
+    k_stack_paint(g_srp_stack_hi, SRP_STACK_SIZE, 0);
+#endif
+
+    // create the rest of the tasks
+    p_taskinfo = task_info;
+    for ( int i = 0; i < num_tasks; i++ ) {
+        TCB *p_tcb = &g_tcbs[i+1];
+        if (k_tsk_create_new(p_taskinfo, p_tcb, i+1) == RTX_OK) {
+        	k_active_add(p_tcb);
+        	k_rdy_push(p_tcb, FALSE);
+        }
+        p_taskinfo++;
+    }
+
+    // create the KCD task at its reserved tid
+    kcd_info.ptask        = &kcd_task;
+    kcd_info.prio         = HIGH;
+    kcd_info.priv         = 0;
+    kcd_info.u_stack_size = KCD_STACK_SIZE;
+    if (k_tsk_create_new(&kcd_info, &g_tcbs[TID_KCD], TID_KCD) == RTX_OK) {
+        k_active_add(&g_tcbs[TID_KCD]);
+        k_rdy_push(&g_tcbs[TID_KCD], FALSE);
+    }
 
-        POP     {R0-R12, PC}
+    // the tids left over, the lowest one on top
+    g_num_free_tid = 0;
+    for ( task_t tid = TID_KCD - 1; tid > TID_NULL; tid-- ) {
+        if ( g_tcbs[tid].state == DORMANT ) {
+            k_tid_free(tid);
+        }
+    }
+    return RTX_OK;
 }
+/**************************************************************************//**
+ * @brief       initialize a new task in the system,
+ *              one dummy kernel stack frame, one dummy user stack frame
+ *
+ * @return      RTX_OK on success; RTX_ERR on failure
+ * @param       p_taskinfo  task information structure pointer
+ * @param       p_tcb       the tcb the task is assigned to
+ * @param       tid         the tid the task is assigned to
+ *
+ * @see         k_tsk_frame
+ *****************************************************************************/
+int k_tsk_create_new(RTX_TASK_INFO *p_taskinfo, TCB *p_tcb, task_t tid)
+{
+    TCB_COLD *p_cold = &g_tcb_cold[tid];
+    U32 *sp;
+    U32 u_stack_hi   = 0;
+    U32 u_stack_size = 0;
 
+    if (p_taskinfo == NULL || p_tcb == NULL)
+    {
+        return RTX_ERR;
+    }
+
+    if (p_taskinfo->prio != PRIO_RT &&
+        (p_taskinfo->prio < HIGH || p_taskinfo->prio > LOWEST)) {
+        return RTX_ERR;
+    }
+
+    /*---------------------------------------------------------------
+     *  Step0: allocate the user stack first, nothing to undo if
+     *         the heap cannot hold it
+     * -------------------------------------------------------------*/
+    if ( p_taskinfo->priv == 0 ) {
+#ifdef KERN_SRP
+        if ( p_taskinfo->prio == PRIO_RT ) {
+            // RT jobs run to completion one at a time, they share one stack
+            u_stack_hi   = g_srp_stack_hi;
+            u_stack_size = SRP_STACK_SIZE;
+        } else
+#endif
+        {
+            u_stack_size = (p_taskinfo->u_stack_size + 7U) & ~7U;
+            if ( u_stack_size < PROC_STACK_SIZE ) {
+                u_stack_size = PROC_STACK_SIZE;
+            }
+            if ( u_stack_size > U_STACK_MAX ) {
+                return RTX_ERR;
+            }
+            u_stack_hi = (U32) k_alloc_p_stack(u_stack_size);
+            if ( u_stack_hi == 0 ) {
+                return RTX_ERR;
+            }
+        }
+    }
+
+    p_tcb ->tid = tid;
+    p_tcb->state = READY;
+    p_tcb->prio  = p_taskinfo->prio;
+    p_cold->priv  = p_taskinfo->priv;
+    p_cold->ptask = p_taskinfo->ptask;
+    p_cold->run_time = 0;
+    p_cold->rt_period = 0;
+    p_cold->rt_idle   = 0;
+    k_vfp_reset(p_tcb);
+    for ( int i = 0; i < PMU_NUM_CNT; i++ ) {
+        p_cold->pmu[i] = 0;
+    }
+    p_tcb->next     = NULL;
+    p_tcb->wait_q   = NULL;
+    p_tcb->tnext    = NULL;
+    p_tcb->timed    = 0;
+
+    /*---------------------------------------------------------------
+     *  Step1: allocate kernel stack for the task
+     *         stacks grows down, stack base is at the high address
+     * -------------------------------------------------------------*/
+
+    ///////sp = g_k_stacks[tid] + (KERN_STACK_SIZE >> 2) ;
+    sp = k_alloc_k_stack(tid);
+    p_cold->k_stack_hi   = (U32) sp;
+    p_cold->k_stack_size = KERN_STACK_SIZE;
+    p_cold->k_stack_used = 0;
+    p_cold->u_stack_used = 0;
+    p_cold->stk_gen++;
+    k_stack_paint(p_cold->k_stack_hi, KERN_STACK_SIZE, 0);
+
+    /*---------------------------------------------------------------
+     *  Step2: the user stack, the shared SRP one is painted once
+     * -------------------------------------------------------------*/
+    p_cold->u_stack_hi   = u_stack_hi;
+    p_cold->u_stack_size = u_stack_size;
+    if ( k_tsk_own_ustack(p_cold) ) {
+        k_stack_paint(u_stack_hi, u_stack_size, 0);
+    }
+
+    p_tcb->msp = k_tsk_frame(sp, p_taskinfo->priv, p_taskinfo->ptask, p_cold->u_stack_hi);
+
+    return RTX_OK;
+}
 
 /**************************************************************************//**
  * @brief       run a new thread. The caller becomes READY and
@@ -330,7 +974,7 @@ K_RESTORE
  * @attention   CRITICAL SECTION
  * !!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!
  *****************************************************************************/
-int k_tsk_run_new(void)
+K_HOT int k_tsk_run_new(void)
 {
     TCB *p_tcb_old = NULL;
     
@@ -338,7 +982,12 @@ int k_tsk_run_new(void)
     	return RTX_ERR;
     }
 
+    g_need_resched = RESCHED_NONE;          // the scheduler runs now anyway
     p_tcb_old = gp_current_task;
+    if (p_tcb_old->state == RUNNING) {
+        p_tcb_old->state = READY;           // a blocking caller keeps its state
+        k_rdy_push(p_tcb_old, FALSE);
+    }
     gp_current_task = scheduler();
     
     if ( gp_current_task == NULL  ) {
@@ -347,9 +996,11 @@ int k_tsk_run_new(void)
     }
 
     // at this point, gp_current_task != NULL and p_tcb_old != NULL
+    gp_current_task->state = RUNNING;       // change state of the to-be-switched-in  tcb
     if (gp_current_task != p_tcb_old) {
-        gp_current_task->state = RUNNING;   // change state of the to-be-switched-in  tcb
-        p_tcb_old->state = READY;           // change state of the to-be-switched-out tcb
+        g_slice_ticks = 0;                  // a fresh time slice
+        k_tsk_account(p_tcb_old);           // charge the outgoing task
+        k_vfp_switch(gp_current_task);      // unit on only for its owner
         k_tsk_switch(p_tcb_old);            // switch stacks
     }
 
@@ -370,6 +1021,26 @@ int k_tsk_yield(void)
     return k_tsk_run_new();
 }
 
+/**************************************************************************//**
+ * @brief       give the cpu to a higher priority READY task, if there is one
+ * @return:     RTX_OK upon success
+ *              RTX_ERR upon failure
+ * @note:       the caller goes back to the head of its ready queue,
+ *              so it resumes before its equal priority peers
+ *****************************************************************************/
+K_HOT int k_tsk_preempt(void)
+{
+    TCB *p_tcb = gp_current_task;
+
+    if ( p_tcb->state != RUNNING ||
+         __clz(g_rdy_map) >= k_prio_level(p_tcb->prio) ) {
+        return RTX_OK;
+    }
+    p_tcb->state = READY;
+    k_rdy_push(p_tcb, TRUE);
+    return k_tsk_run_new();
+}
+
 
 /*
  *===========================================================================
@@ -377,22 +1048,80 @@ int k_tsk_yield(void)
  *===========================================================================
  */
 
+/**************************************************************************//**
+ * @brief       create an unprivileged task, it preempts the caller if it
+ *              has a higher priority
+ * @param       task        the tid of the new task is written here
+ * @param       task_entry  entry point, the task ends with tsk_exit
+ * @param       prio        HIGH to LOWEST
+ * @param       stack_size  user stack size in bytes, taken from the heap,
+ *                          rounded up to PROC_STACK_SIZE at least
+ * @return      RTX_OK on success, RTX_ERR on failure
+ * @note        O(1), the tid comes off the top of the free tid stack
+ *****************************************************************************/
 int k_tsk_create(task_t *task, void (*task_entry)(void), U8 prio, U16 stack_size)
 {
+    RTX_TASK_INFO info;
+    task_t tid;
+
 #ifdef DEBUG_0
     printf("k_tsk_create: entering...\n\r");
     printf("task = 0x%x, task_entry = 0x%x, prio=%d, stack_size = %d\n\r", task, task_entry, prio, stack_size);
 #endif /* DEBUG_0 */
-    return RTX_OK;
+    if ( task == NULL || task_entry == NULL || prio == PRIO_RT ) {
+        return RTX_ERR;
+    }
+    tid = k_tid_alloc();
+    if ( tid == TID_NULL ) {
+        return RTX_ERR;
+    }
 
+    info.ptask        = task_entry;
+    info.prio         = prio;
+    info.priv         = 0;
+    info.u_stack_size = stack_size;
+    if ( k_tsk_create_new(&info, &g_tcbs[tid], tid) != RTX_OK ) {
+        k_tid_free(tid);
+        return RTX_ERR;
+    }
+    k_active_add(&g_tcbs[tid]);
+    k_rdy_push(&g_tcbs[tid], FALSE);
+    *task = tid;
+    if ( prio < gp_current_task->prio ) {
+        k_tsk_need_resched(RESCHED_PREEMPT);
+    }
+    return RTX_OK;
 }
 
+/**************************************************************************//**
+ * @brief       end the running task, its tid goes back on the free tid stack
+ * @note        the mailbox and the user stack of the task are freed, it is
+ *              on its kernel stack by now. An RT job gives up the shared
+ *              stack first. The null task cannot exit
+ *****************************************************************************/
 void k_tsk_exit(void) 
 {
+    TCB *p_tcb = gp_current_task;
+
 #ifdef DEBUG_0
     printf("k_tsk_exit: entering...\n\r");
 #endif /* DEBUG_0 */
-    return;
+    if ( p_tcb->tid == TID_NULL ) {
+        return;
+    }
+#ifdef KERN_SRP
+    if ( g_srp_owner == p_tcb ) {
+        k_srp_release();
+    }
+#endif
+    k_mbx_free(p_tcb->tid);
+    k_tsk_free_ustack(k_tcb_cold(p_tcb));
+    k_tcb_cold(p_tcb)->stk_gen++;
+    k_tcb_cold(p_tcb)->rt_period = 0;
+    p_tcb->state = DORMANT;
+    k_active_remove(p_tcb);
+    k_tid_free(p_tcb->tid);
+    k_tsk_run_new();
 }
 
 int k_tsk_set_prio(task_t task_id, U8 prio) 
@@ -406,33 +1135,51 @@ int k_tsk_set_prio(task_t task_id, U8 prio)
 
 int k_tsk_get(task_t task_id, RTX_TASK_INFO *buffer)
 {
+    TCB *p_tcb;
+
 #ifdef DEBUG_0
     printf("k_tsk_get: entering...\n\r");
     printf("task_id = %d, buffer = 0x%x.\n\r", task_id, buffer);
 #endif /* DEBUG_0 */    
-    if (buffer == NULL) {
+    if (buffer == NULL || task_id >= MAX_TASKS) {
+        return RTX_ERR;
+    }
+
+    p_tcb = &g_tcbs[task_id];
+    if (p_tcb->state == DORMANT) {
         return RTX_ERR;
     }
-    /* The code fills the buffer with some fake task information. 
-       You should fill the buffer with correct information    */
-    buffer->tid = task_id;
-    buffer->prio = 99;
-    buffer->state = 101;
-    buffer->priv = 0;
-    buffer->ptask = 0x0;
-    buffer->k_sp = 0xBEEFDEAD;
-    buffer->k_stack_size = KERN_STACK_SIZE;
-    buffer->u_sp = 0xDEADBEEF;
-    buffer->u_stack_size = 0x200;
+
+    buffer->tid          = p_tcb->tid;
+    buffer->prio         = p_tcb->prio;
+    buffer->state        = p_tcb->state;
+    buffer->priv         = k_tcb_cold(p_tcb)->priv;
+    buffer->ptask        = k_tcb_cold(p_tcb)->ptask;
+    buffer->k_stack_hi   = k_tcb_cold(p_tcb)->k_stack_hi;
+    buffer->k_stack_size = k_tcb_cold(p_tcb)->k_stack_size;
+    buffer->u_stack_hi   = k_tcb_cold(p_tcb)->u_stack_hi;
+    buffer->u_stack_size = k_tcb_cold(p_tcb)->u_stack_size;
+    buffer->k_sp = (p_tcb == gp_current_task) ? __current_sp() : (U32) p_tcb->msp;
+    buffer->u_sp = 0;   // the user sp lives in the exception frame, not tracked
 
     return RTX_OK;     
 }
 
 int k_tsk_ls(task_t *buf, int count){
+    int n = 0;
+
 #ifdef DEBUG_0
     printf("k_tsk_ls: buf=0x%x, count=%d\r\n", buf, count);
 #endif /* DEBUG_0 */
-    return 0;
+    if (buf == NULL || count <= 0) {
+        return RTX_ERR;
+    }
+
+    for ( TCB *p_tcb = g_active_head; p_tcb != NULL && n < count;
+          p_tcb = k_tcb_cold(p_tcb)->a_next ) {
+        buf[n++] = p_tcb->tid;
+    }
+    return n;
 }
 
 /*
@@ -441,16 +1188,98 @@ int k_tsk_ls(task_t *buf, int count){
  *===========================================================================
  */
 
+/**************************************************************************//**
+ * @brief       create a periodic real-time task, its first job is
+ *              released right away
+ * @param       tid     the tid of the new task is written here
+ * @param       task    period, entry, user stack size and mailbox size
+ * @return      RTX_OK on success, RTX_ERR on failure
+ * @note        each job ends with tsk_done_rt. With KERN_SRP the next job
+ *              starts at task_entry again, on the shared RT stack, so a
+ *              job must not keep state on its stack between releases
+ *****************************************************************************/
 int k_tsk_create_rt(task_t *tid, TASK_RT *task)
 {
-    return 0;
+    RTX_TASK_INFO info;
+    TCB *p_tcb;
+    TCB_COLD *p_cold;
+    U32 period;
+    task_t t;
+
+#ifdef DEBUG_0
+    printf("k_tsk_create_rt: tid = 0x%x, task = 0x%x\r\n", tid, task);
+#endif /* DEBUG_0 */
+    if ( tid == NULL || task == NULL || task->task_entry == NULL ) {
+        return RTX_ERR;
+    }
+    period = k_tv_to_ticks(&task->p_n);
+#ifdef KERN_SRP
+    // the shared stack is sized at build time, every job has to fit
+    if ( period == 0 || task->u_stack_size > SRP_STACK_SIZE ) {
+#else
+    if ( period == 0 ) {
+#endif
+        return RTX_ERR;
+    }
+
+    t = k_tid_alloc();
+    if ( t == TID_NULL ) {
+        return RTX_ERR;
+    }
+    p_tcb  = &g_tcbs[t];
+    p_cold = &g_tcb_cold[t];
+
+    info.ptask        = task->task_entry;
+    info.prio         = PRIO_RT;
+    info.priv         = 0;
+    info.u_stack_size = task->u_stack_size;
+    if ( k_tsk_create_new(&info, p_tcb, t) != RTX_OK ) {
+        k_tid_free(t);
+        return RTX_ERR;
+    }
+    if ( task->rt_mbx_size != 0 && k_mbx_create_tid(t, task->rt_mbx_size, 1) == RTX_ERR ) {
+        k_tsk_free_ustack(p_cold);
+        p_tcb->state = DORMANT;
+        k_tid_free(t);
+        return RTX_ERR;
+    }
+    k_active_add(p_tcb);
+    *tid = t;
+
+    p_cold->rt_period  = period;
+    p_cold->rt_release = g_ticks;
+    p_tcb->state = SUSPENDED;
+    k_tsk_rt_release(p_tcb);
+    return RTX_OK;
 }
 
+/**************************************************************************//**
+ * @brief       end the current job of an RT task, wait for its next release
+ * @note        a job that overran its period skips the releases it missed.
+ *              Not an RT task: returns at once
+ *****************************************************************************/
 void k_tsk_done_rt(void) {
+    TCB *p_tcb = gp_current_task;
+    TCB_COLD *p_cold = k_tcb_cold(p_tcb);
+
 #ifdef DEBUG_0
     printf("k_tsk_done: Entering\r\n");
 #endif /* DEBUG_0 */
-    return;
+    if ( p_cold->rt_period == 0 ) {
+        return;
+    }
+    do {
+        p_cold->rt_release += p_cold->rt_period;
+    } while ( (int) (p_cold->rt_release - g_ticks) <= 0 );
+
+#ifdef KERN_SRP
+    k_srp_release();
+#endif
+
+    p_cold->rt_idle = 1;
+    p_tcb->state = SUSPENDED;
+    k_timer_add(p_tcb, p_cold->rt_release - g_ticks);
+    k_tsk_run_new();
 }
 
 void k_tsk_suspend(TIMEVAL *tv)
@@ -458,7 +1287,10 @@ void k_tsk_suspend(TIMEVAL *tv)
 #ifdef DEBUG_0
     printf("k_tsk_suspend: Entering\r\n");
 #endif /* DEBUG_0 */
-    return;
+    if ( tv == NULL || (tv->sec == 0 && tv->usec == 0) ) {
+        return;
+    }
+    k_tsk_block(SUSPENDED, NULL, tv);
 }
 
 /*
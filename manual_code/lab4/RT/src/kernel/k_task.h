@@ -60,6 +60,7 @@ extern TCB *gp_current_task;
  */
 
 extern void task_null	(void);
+extern void kcd_task	(void);
 
 
 // Implemented by Starter Code
@@ -72,12 +73,27 @@ TCB *scheduler          (void);  /* return the TCB of the next ready to run task
 void k_tsk_switch       (TCB *); /* kernel thread context switch, two stacks */
 int  k_tsk_run_new      (void);  /* kernel runs a new thread  */
 int  k_tsk_yield        (void);  /* kernel tsk_yield function */
+int  k_tsk_preempt      (void);  /* switch if a higher priority task is READY */
+void k_tsk_ready        (TCB *); /* make a blocked task ready to run */
+BOOL k_tsk_wake         (TCB *, int rc);
+                                 /* end a blocking wait, TRUE if the task should preempt */
+void k_tsk_need_resched (U32 how); /* ask for a switch at the outermost kernel exit */
+int  k_tsk_resched      (void);  /* act on g_need_resched */
+int  k_tsk_block        (U8 state, TCB **wait_q, const TIMEVAL *tv);
+                                 /* block the running task, NULL tv waits forever */
+BOOL k_tsk_tick         (void);  /* advance the timer queue by one tick */
+int  k_get_time         (TIMEVAL *tv);  /* time since boot, tick resolution */
+void k_tsk_account      (TCB *); /* charge elapsed run time to a task */
+U32  k_tsk_stack_used   (TCB *); /* kernel stack high-water mark in bytes */
+U32  k_tsk_ustack_used  (TCB *); /* user stack high-water mark in bytes */
+void k_tsk_scan_idle    (void);  /* refresh one task's high-water marks */
 
 // Not implemented, to be done by students
 int  k_tsk_create       (task_t *task, void (*task_entry)(void), U8 prio, U16 stack_size);
 void k_tsk_exit         (void);
 int  k_tsk_set_prio     (task_t task_id, U8 prio);
 int  k_tsk_get          (task_t task_id, RTX_TASK_INFO *buffer);
+int  k_tsk_ls           (task_t *buf, int count);
 int k_tsk_create_rt(task_t *tid, TASK_RT *task);
 void k_tsk_done_rt      (void);
 void k_tsk_suspend      (struct timeval_rt *tv);
@@ -0,0 +1,128 @@
+/*
+ ****************************************************************************
+ *
+ *                  UNIVERSITY OF WATERLOO ECE 350 RTOS LAB
+ *
+ *                     Copyright 2020-2021 Yiqing Huang
+ *                          All rights reserved.
+ *
+ *  Redistribution and use in source and binary forms, with or without
+ *  modification, are permitted provided that the following conditions are met:
+ *  - Redistributions of source code must retain the above copyright
+ *    notice and the following disclaimer.
+ *
+ *
+ *  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ *  AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ *  IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ *  ARE DISCLAIMED. IN NO EVENT SHALL COPYRIGHT HOLDERS AND CONTRIBUTORS BE
+ *  LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ *  CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ *  SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ *  INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ *  CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ *  ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ *  POSSIBILITY OF SUCH DAMAGE.
+ ****************************************************************************
+ */
+
+/**************************************************************************//**
+ * @file        k_vfp.c
+ * @brief       Lazy VFP/NEON Context C File
+ *
+ * @version     V1.2021.01
+ * @authors     Yiqing Huang
+ * @date        2021 JAN
+ *
+ * @details     The register bank stays with the last task that used it,
+ *              g_vfp_owner. A switch only sets FPEXC.EN for the owner, so
+ *              any other task's first VFP/NEON instruction traps through
+ *              Undef_Handler into k_vfp_claim, which swaps the banks and
+ *              lets the instruction run again. Integer-only tasks never
+ *              pay for the 264 byte save.
+ *
+ *****************************************************************************/
+
+#include "k_vfp.h"
+#include "k_HAL_CA.h"
+
+/*
+ *===========================================================================
+ *                            GLOBAL VARIABLES
+ *===========================================================================
+ */
+
+static VFP_CTX  g_vfp_ctx[MAX_TASKS] __attribute__((aligned(8)));
+static TCB     *g_vfp_owner;    // task whose registers are in the unit
+
+/*
+ *===========================================================================
+ *                            FUNCTIONS
+ *===========================================================================
+ */
+
+/**************************************************************************//**
+ * @brief       grant cp10/cp11 access and leave the unit off
+ *****************************************************************************/
+void k_vfp_init(void)
+{
+    U32 cpacr;
+
+    CP15_RD(cpacr, 0, c1, c0, 2);
+    CP15_WR(cpacr | CPACR_CP10_11, 0, c1, c0, 2);
+    __isb(0xF);
+    __set_FPEXC(0);
+    g_vfp_owner = NULL;
+}
+
+/**************************************************************************//**
+ * @brief       give a new task a zeroed bank
+ * @note        a recycled tid must not see the previous task's registers
+ *****************************************************************************/
+void k_vfp_reset(TCB *p_tcb)
+{
+    VFP_CTX *p_ctx = &g_vfp_ctx[p_tcb->tid];
+
+    if ( g_vfp_owner == p_tcb ) {
+        g_vfp_owner = NULL;
+    }
+    for ( int i = 0; i < 32; i++ ) {
+        p_ctx->d[i] = 0;
+    }
+    p_ctx->fpscr = 0;
+}
+
+/**************************************************************************//**
+ * @brief       enable the unit only for the task that owns the bank
+ * @param       p_tcb   task about to be switched in
+ *****************************************************************************/
+void k_vfp_switch(TCB *p_tcb)
+{
+    __set_FPEXC((p_tcb == g_vfp_owner) ? FPEXC_EN : 0);
+}
+
+/**************************************************************************//**
+ * @brief       hand the unit to the running task
+ * @note        called from Undef_Handler with IRQs masked after a VFP/NEON
+ *              instruction trapped with the unit off
+ *****************************************************************************/
+void k_vfp_claim(void)
+{
+    TCB *p_tcb = gp_current_task;
+
+    __set_FPEXC(FPEXC_EN);
+    if ( g_vfp_owner == p_tcb ) {
+        return;
+    }
+    if ( g_vfp_owner != NULL ) {
+        __vfp_save(&g_vfp_ctx[g_vfp_owner->tid]);
+    }
+    __vfp_restore(&g_vfp_ctx[p_tcb->tid]);
+    g_vfp_owner = p_tcb;
+}
+
+/*
+ *===========================================================================
+ *                             END OF FILE
+ *===========================================================================
+ */
@@ -0,0 +1,154 @@
+/*
+ ****************************************************************************
+ *
+ *                  UNIVERSITY OF WATERLOO ECE 350 RTOS LAB
+ *
+ *                     Copyright 2020-2021 Yiqing Huang
+ *                          All rights reserved.
+ *
+ *  Redistribution and use in source and binary forms, with or without
+ *  modification, are permitted provided that the following conditions are met:
+ *  - Redistributions of source code must retain the above copyright
+ *    notice and the following disclaimer.
+ *
+ *
+ *  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ *  AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ *  IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ *  ARE DISCLAIMED. IN NO EVENT SHALL COPYRIGHT HOLDERS AND CONTRIBUTORS BE
+ *  LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ *  CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ *  SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ *  INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ *  CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ *  ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ *  POSSIBILITY OF SUCH DAMAGE.
+ ****************************************************************************
+ */
+/**************************************************************************//**
+ * @file        k_work.c
+ * @brief       Deferred Interrupt Work C File
+ *
+ * @version     V1.2021.01
+ * @authors     Yiqing Huang
+ * @date        2021 JAN
+ *
+ * @details     Interrupt handlers queue small work items here and return;
+ *              the items run once the outermost handler has ended its
+ *              interrupt, on the interrupt stack with IRQs enabled.
+ *              The queue is a bounded ring with a sequence number per slot.
+ *              Handlers of any nesting level reserve a slot with LDREX/STREX
+ *              and publish it by bumping its sequence number, so no
+ *              producer ever masks interrupts. There is a single consumer,
+ *              the outermost interrupt level.
+ *
+ *****************************************************************************/
+
+#include "k_work.h"
+#include "interrupt.h"
+
+/*
+ *==========================================================================
+ *                            STRUCTURES
+ *==========================================================================
+ */
+
+typedef struct work {
+    WORK_FN volatile    fn;
+    U32 volatile        arg;
+    U32 volatile        seq;    /**> == pos when free, == pos + 1 when filled */
+} WORK;
+
+/*
+ *==========================================================================
+ *                            GLOBAL VARIABLES
+ *==========================================================================
+ */
+
+static WORK         g_work[WORK_QUEUE_SIZE];
+static U32 volatile g_work_tail;    // next position to reserve, producers
+static U32          g_work_head;    // next position to run, consumer only
+static U32          g_work_drop;    // items refused because the ring was full
+
+/*
+ *===========================================================================
+ *                            FUNCTIONS
+ *===========================================================================
+ */
+
+void k_work_init(void)
+{
+    for (U32 i = 0; i < WORK_QUEUE_SIZE; i++) {
+        g_work[i].seq = i;
+    }
+    g_work_tail = 0;
+    g_work_head = 0;
+    g_work_drop = 0;
+}
+
+/**************************************************************************//**
+ * @brief       queue fn(arg) to run after the hard interrupt
+ * @return      RTX_OK on success; RTX_ERR if the queue is full
+ * @note        lock-free, callable from any interrupt nesting level
+ *****************************************************************************/
+int k_work_queue(WORK_FN fn, U32 arg)
+{
+    U32 pos;
+    WORK *p_work;
+
+    do {
+        pos = __ldrex(&g_work_tail);
+        p_work = &g_work[pos & (WORK_QUEUE_SIZE - 1)];
+        if (p_work->seq != pos) {
+            __clrex();          // the slot has not been run yet, ring is full
+            g_work_drop++;
+            return RTX_ERR;
+        }
+    } while (__strex(pos + 1, &g_work_tail) != 0);
+
+    p_work->fn  = fn;
+    p_work->arg = arg;
+    p_work->seq = pos + 1;      // publish
+    return RTX_OK;
+}
+
+/**************************************************************************//**
+ * @brief       is there published work waiting to run
+ *****************************************************************************/
+BOOL k_work_pending(void)
+{
+    return g_work[g_work_head & (WORK_QUEUE_SIZE - 1)].seq == g_work_head + 1;
+}
+
+/**************************************************************************//**
+ * @brief       run the queued work in order
+ * @return      the strongest IRQ_DONE/IRQ_PREEMPT/IRQ_YIELD request
+ * @note        only the outermost interrupt level calls this
+ *****************************************************************************/
+U32 k_work_run(void)
+{
+    U32 rc = IRQ_DONE;
+
+    while (k_work_pending()) {
+        WORK *p_work = &g_work[g_work_head & (WORK_QUEUE_SIZE - 1)];
+        U32 r = p_work->fn(p_work->arg);
+
+        if (r > rc) {
+            rc = r;
+        }
+        p_work->seq = g_work_head + WORK_QUEUE_SIZE;   // free for the next lap
+        g_work_head++;
+    }
+    return rc;
+}
+
+U32 k_work_drops(void)
+{
+    return g_work_drop;
+}
+
+/*
+ *===========================================================================
+ *                             END OF FILE
+ *===========================================================================
+ */
@@ -57,6 +57,12 @@ void task_null (void)
             printf("==============Task NULL===============\r\n");
         }
 #endif
+        // runs in SVC mode with IRQs masked: every task may be blocked,
+        // sleep with IRQs on until an interrupt wakes one of them up
+        k_tsk_scan_idle();
+        __enable_irq();
+        __wfi();
+        __disable_irq();
         k_tsk_yield();
     }
 }
@@ -0,0 +1,83 @@
+#!/usr/bin/env python3
+"""Symbolize RTX profiler samples into a flat profile and folded stacks.
+
+Capture the console while the KCD runs %PS, then %PX and %PD. Each sample
+is a "PROF,<pc hex>,<mode hex>,<tid>" line. Symbols come from the image's
+symbol table via nm, e.g.
+
+    prof.py console.log --elf RT.axf --folded rt.folded
+    flamegraph.pl rt.folded > rt.svg
+
+Folded stacks are task;mode;function, which is as deep as a PC sample goes.
+"""
+
+import argparse
+import bisect
+import collections
+import re
+import subprocess
+import sys
+
+MODES = {0x10: "USR", 0x11: "FIQ", 0x12: "IRQ", 0x13: "SVC",
+         0x17: "ABT", 0x1B: "UND", 0x1F: "SYS"}
+
+SAMPLE_RE = re.compile(r"PROF,([0-9a-fA-F]{8}),([0-9a-fA-F]{2}),(\d+)")
+
+
+def load_symbols(elf, nm):
+    """Return sorted (addr, name) pairs of the function symbols in elf."""
+    out = subprocess.run([nm, "-n", "--defined-only", elf], check=True,
+                         capture_output=True, text=True).stdout
+    syms = []
+    for line in out.splitlines():
+        parts = line.split()
+        if len(parts) == 3 and parts[1] in "tTwW":
+            syms.append((int(parts[0], 16) & ~1, parts[2]))
+    syms.sort()
+    return syms
+
+
+def symbolize(syms, addrs, pc):
+    i = bisect.bisect_right(addrs, pc) - 1
+    return syms[i][1] if i >= 0 else "0x%08x" % pc
+
+
+def main():
+    ap = argparse.ArgumentParser(description=__doc__.splitlines()[0])
+    ap.add_argument("log", help="console capture holding PROF lines")
+    ap.add_argument("--elf", help="image the samples were taken from")
+    ap.add_argument("--nm", default="arm-none-eabi-nm", help="nm to run")
+    ap.add_argument("--folded", help="write folded stacks to this file")
+    ap.add_argument("--top", type=int, default=30, help="rows to print")
+    args = ap.parse_args()
+
+    syms = load_symbols(args.elf, args.nm) if args.elf else []
+    addrs = [a for a, _ in syms]
+
+    flat = collections.Counter()
+    folded = collections.Counter()
+    total = 0
+    with open(args.log, errors="replace") as f:
+        for m in SAMPLE_RE.finditer(f.read()):
+            pc, mode, tid = int(m.group(1), 16), int(m.group(2), 16), int(m.group(3))
+            func = symbolize(syms, addrs, pc) if syms else "0x%08x" % pc
+            flat[func] += 1
+            folded["tid%d;%s;%s" % (tid, MODES.get(mode, "0x%02x" % mode), func)] += 1
+            total += 1
+
+    if total == 0:
+        sys.exit("no PROF samples in %s" % args.log)
+
+    print("%8s %6s  %s" % ("samples", "%", "function"))
+    for func, n in flat.most_common(args.top):
+        print("%8d %6.2f  %s" % (n, 100.0 * n / total, func))
+    print("%8d  total" % total)
+
+    if args.folded:
+        with open(args.folded, "w") as f:
+            for stack, n in sorted(folded.items()):
+                f.write("%s %d\n" % (stack, n))
+
+
+if __name__ == "__main__":
+    main()